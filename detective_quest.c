@@ -4,6 +4,98 @@
  */
 
 #include "detective_quest.h"
+#include "registro_casos.h"
+#include "rastreamento.h"
+
+#include <stddef.h>
+#include <limits.h>
+#include <pthread.h>
+
+// ============ IMPLEMENTAÇÃO: POOL DE TEXTOS ============
+
+/**
+ * Texto internado: contagem de referências + encadeamento do bucket
+ * O texto fica no próprio bloco (membro flexível)
+ */
+typedef struct TextoInternado {
+    struct TextoInternado *proximo;
+    int referencias;
+    size_t tamanho;
+    char texto[];
+} TextoInternado;
+
+static TextoInternado *poolTextos[TEXTOS_BUCKETS];
+static size_t bytesPoolTextos = 0;
+
+/**
+ * hashTexto() - FNV-1a sobre os primeiros tamanho bytes
+ */
+static unsigned hashTexto(const char *texto, size_t tamanho) {
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < tamanho; i++) {
+        hash ^= (unsigned char)texto[i];
+        hash *= 16777619u;
+    }
+    return hash % TEXTOS_BUCKETS;
+}
+
+/**
+ * internarTexto() - Procura no bucket; se ausente, cria a cópia compartilhada
+ */
+const char *internarTexto(const char *texto, size_t limite) {
+    size_t tamanho = 0;
+    while (tamanho < limite - 1 && texto[tamanho] != '\0') {
+        tamanho++;
+    }
+    unsigned bucket = hashTexto(texto, tamanho);
+    
+    for (TextoInternado *atual = poolTextos[bucket]; atual != NULL; atual = atual->proximo) {
+        if (atual->tamanho == tamanho && memcmp(atual->texto, texto, tamanho) == 0) {
+            atual->referencias++;
+            return atual->texto;
+        }
+    }
+    
+    TextoInternado *novo = (TextoInternado *)malloc(sizeof(TextoInternado) + tamanho + 1);
+    if (novo == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para texto!\n");
+        return NULL;
+    }
+    memcpy(novo->texto, texto, tamanho);
+    novo->texto[tamanho] = '\0';
+    novo->tamanho = tamanho;
+    novo->referencias = 1;
+    novo->proximo = poolTextos[bucket];
+    poolTextos[bucket] = novo;
+    bytesPoolTextos += sizeof(TextoInternado) + tamanho + 1;
+    
+    return novo->texto;
+}
+
+/**
+ * liberarTexto() - Decrementa referências e remove o texto do bucket ao zerar
+ */
+void liberarTexto(const char *texto) {
+    if (texto == NULL) return;
+    
+    TextoInternado *entrada = (TextoInternado *)(texto - offsetof(TextoInternado, texto));
+    if (--entrada->referencias > 0) return;
+    
+    TextoInternado **elo = &poolTextos[hashTexto(entrada->texto, entrada->tamanho)];
+    while (*elo != entrada) {
+        elo = &(*elo)->proximo;
+    }
+    *elo = entrada->proximo;
+    bytesPoolTextos -= sizeof(TextoInternado) + entrada->tamanho + 1;
+    free(entrada);
+}
+
+/**
+ * bytesTextosInternados() - Total de bytes alocados pelo pool
+ */
+size_t bytesTextosInternados(void) {
+    return bytesPoolTextos;
+}
 
 // ============ IMPLEMENTAÇÃO: SALAS (ÁRVORE BINÁRIA) ============
 
@@ -18,14 +110,20 @@ NoSala *criarSala(const char *nome, const char *pista) {
         return NULL;
     }
     
-    strncpy(novaSala->nome, nome, SALA_LEN - 1);
-    novaSala->nome[SALA_LEN - 1] = '\0';
-    
-    strncpy(novaSala->pista, pista, PISTA_LEN - 1);
-    novaSala->pista[PISTA_LEN - 1] = '\0';
+    novaSala->nome = internarTexto(nome, SALA_LEN);
+    novaSala->pista = internarTexto(pista, PISTA_LEN);
+    if (novaSala->nome == NULL || novaSala->pista == NULL) {
+        liberarTexto(novaSala->nome);
+        liberarTexto(novaSala->pista);
+        free(novaSala);
+        return NULL;
+    }
     
     novaSala->esquerda = NULL;
     novaSala->direita = NULL;
+    novaSala->pai = NULL;
+    novaSala->id = 0;
+    novaSala->suspeito = -1;
     
     return novaSala;
 }
@@ -71,28 +169,58 @@ void exibirSala(NoSala *no) {
     printf("Opções:\n");
     printf("  [e] - Ir para esquerda\n");
     printf("  [d] - Ir para direita\n");
+    printf("  [v] - Voltar (desfazer último movimento)\n");
     printf("  [s] - Sair e fazer acusação\n");
     printf("========================================\n");
 }
 
 // ============ IMPLEMENTAÇÃO: BST DE PISTAS ============
 
+/**
+ * criarNoPista() - Aloca um nó de pista com uma referência
+ */
+static NoPista *criarNoPista(const char *pista, NoPista *esquerda, NoPista *direita) {
+    NoPista *noNovo = (NoPista *)malloc(sizeof(NoPista));
+    if (noNovo == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para pista!\n");
+        return NULL;
+    }
+    strncpy(noNovo->pista, pista, PISTA_LEN - 1);
+    noNovo->pista[PISTA_LEN - 1] = '\0';
+    noNovo->esquerda = esquerda;
+    noNovo->direita = direita;
+    noNovo->referencias = 1;
+    noNovo->bloco = NULL;
+    return noNovo;
+}
+
+/**
+ * Bloco de nós da construção em lote: uma única alocação
+ * vivos conta os nós ainda não liberados
+ */
+typedef struct BlocoPistas {
+    int vivos;
+    NoPista nos[];
+} BlocoPistas;
+
+/**
+ * descartarNoPista() - Libera um nó; nós de bloco liberam o bloco com o último
+ */
+static void descartarNoPista(NoPista *no) {
+    if (no->bloco == NULL) {
+        free(no);
+    } else if (--no->bloco->vivos == 0) {
+        free(no->bloco);
+    }
+}
+
 /**
  * inserirPista() - Insere pista na BST de forma ordenada
  * Implementa inserção recursiva com verificação de duplicatas
  */
 NoPista *inserirPista(NoPista *raiz, const char *pista) {
     if (raiz == NULL) {
-        NoPista *noNovo = (NoPista *)malloc(sizeof(NoPista));
-        if (noNovo == NULL) {
-            fprintf(stderr, "Erro ao alocar memória para pista!\n");
-            return NULL;
-        }
-        strncpy(noNovo->pista, pista, PISTA_LEN - 1);
-        noNovo->pista[PISTA_LEN - 1] = '\0';
-        noNovo->esquerda = NULL;
-        noNovo->direita = NULL;
-        return noNovo;
+        return criarNoPista(pista, NULL, NULL);
     }
     
     int comparacao = strcmp(pista, raiz->pista);
@@ -156,99 +284,535 @@ void liberarPistas(NoPista *raiz) {
     if (raiz == NULL) return;
     liberarPistas(raiz->esquerda);
     liberarPistas(raiz->direita);
-    free(raiz);
+    descartarNoPista(raiz);
+}
+
+// ============ IMPLEMENTAÇÃO: PISTAS PERSISTENTES ============
+
+static void registrarColeta(JogoDetectiveQuest *jogo, const NoSala *sala, int delta);
+static int garantirColetasExclusivas(JogoDetectiveQuest *jogo);
+
+/**
+ * copiarCaminho() - Copia o caminho de busca até a posição da nova pista
+ * Só é chamada quando a pista ainda não está na árvore
+ */
+static NoPista *copiarCaminho(NoPista *raiz, const char *pista) {
+    if (raiz == NULL) {
+        return criarNoPista(pista, NULL, NULL);
+    }
+    
+    NoPista *esquerda, *direita;
+    if (strcmp(pista, raiz->pista) < 0) {
+        esquerda = copiarCaminho(raiz->esquerda, pista);
+        if (esquerda == NULL) return NULL;
+        direita = reterPistas(raiz->direita);
+    } else {
+        esquerda = reterPistas(raiz->esquerda);
+        direita = copiarCaminho(raiz->direita, pista);
+        if (direita == NULL) {
+            soltarPistas(esquerda);
+            return NULL;
+        }
+    }
+    
+    NoPista *copia = criarNoPista(raiz->pista, esquerda, direita);
+    if (copia == NULL) {
+        soltarPistas(esquerda);
+        soltarPistas(direita);
+    }
+    return copia;
+}
+
+/**
+ * inserirPistaPersistente() - Inserção com cópia de caminho
+ * Só os nós do caminho de busca são duplicados; o resto é compartilhado
+ */
+NoPista *inserirPistaPersistente(NoPista *raiz, const char *pista) {
+    // Pista já existe em qualquer profundidade: a nova versão é a própria árvore
+    if (buscarPista(raiz, pista)) return reterPistas(raiz);
+    
+    return copiarCaminho(raiz, pista);
+}
+
+/**
+ * ligarBalanceada() - Liga nos[inicio..fim) com o elemento do meio como raiz
+ */
+static NoPista *ligarBalanceada(NoPista *nos, int inicio, int fim) {
+    if (inicio >= fim) return NULL;
+    
+    int meio = inicio + (fim - inicio) / 2;
+    nos[meio].esquerda = ligarBalanceada(nos, inicio, meio);
+    nos[meio].direita = ligarBalanceada(nos, meio + 1, fim);
+    return &nos[meio];
+}
+
+/**
+ * construirPistasOrdenadas() - Copia as pistas distintas para um bloco e liga em O(n)
+ */
+NoPista *construirPistasOrdenadas(const char *const *pistas, int quantidade, int *total) {
+    if (total != NULL) *total = 0;
+    if (pistas == NULL || quantidade <= 0) return NULL;
+    
+    BlocoPistas *bloco = (BlocoPistas *)malloc(sizeof(BlocoPistas) + sizeof(NoPista) * (size_t)quantidade);
+    if (bloco == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para pistas!\n");
+        return NULL;
+    }
+    
+    int distintas = 0;
+    for (int i = 0; i < quantidade; i++) {
+        NoPista *no = &bloco->nos[distintas];
+        strncpy(no->pista, pistas[i], PISTA_LEN - 1);
+        no->pista[PISTA_LEN - 1] = '\0';
+        
+        // Compara já truncado, como a BST compara
+        if (distintas > 0) {
+            int comparacao = strcmp(no->pista, bloco->nos[distintas - 1].pista);
+            if (comparacao == 0) continue;
+            if (comparacao < 0) {
+                fprintf(stderr, "Pistas fora de ordem na construção em lote!\n");
+                free(bloco);
+                return NULL;
+            }
+        }
+        
+        no->referencias = 1;
+        no->bloco = bloco;
+        distintas++;
+    }
+    
+    bloco->vivos = distintas;
+    if (total != NULL) *total = distintas;
+    return ligarBalanceada(bloco->nos, 0, distintas);
+}
+
+/**
+ * reterPistas() - Incrementa o contador de referências da raiz
+ */
+NoPista *reterPistas(NoPista *raiz) {
+    if (raiz != NULL) raiz->referencias++;
+    return raiz;
+}
+
+/**
+ * soltarPistas() - Decrementa referências e libera nós órfãos (postorder)
+ */
+void soltarPistas(NoPista *raiz) {
+    if (raiz == NULL) return;
+    if (--raiz->referencias > 0) return;
+    soltarPistas(raiz->esquerda);
+    soltarPistas(raiz->direita);
+    descartarNoPista(raiz);
+}
+
+/**
+ * salvarVersaoPistas() - Empilha a versão atual (pilha com crescimento dobrado)
+ */
+int salvarVersaoPistas(JogoDetectiveQuest *jogo) {
+    if (jogo == NULL) return 0;
+    
+    if (jogo->tamHistorico == jogo->capHistorico) {
+        int novaCap = jogo->capHistorico > 0 ? jogo->capHistorico * 2 : 16;
+        VersaoPistas *novo = (VersaoPistas *)realloc(jogo->historico, sizeof(VersaoPistas) * novaCap);
+        if (novo == NULL) {
+            fprintf(stderr, "Erro ao alocar memória para histórico!\n");
+            return 0;
+        }
+        jogo->historico = novo;
+        jogo->capHistorico = novaCap;
+    }
+    
+    VersaoPistas *versao = &jogo->historico[jogo->tamHistorico++];
+    versao->raizPistas = reterPistas(jogo->raizPistas);
+    versao->totalPistas = jogo->totalPistas;
+    versao->salaColetada = NULL;
+    return 1;
+}
+
+/**
+ * desfazerVersaoPistas() - Descarta a versão atual e volta à anterior
+ */
+int desfazerVersaoPistas(JogoDetectiveQuest *jogo) {
+    if (jogo == NULL || jogo->tamHistorico == 0) return 0;
+    if (!garantirColetasExclusivas(jogo)) return 0;
+    
+    VersaoPistas *versao = &jogo->historico[--jogo->tamHistorico];
+    if (versao->salaColetada != NULL) {
+        registrarColeta(jogo, versao->salaColetada, -1);
+    }
+    soltarPistas(jogo->raizPistas);
+    // A referência da pilha passa a pertencer ao estado atual
+    jogo->raizPistas = versao->raizPistas;
+    jogo->totalPistas = versao->totalPistas;
+    return 1;
+}
+
+/**
+ * recontarColetas() - Pós-ordem: soma as linhas dos filhos e a coleta da própria sala
+ */
+static void recontarColetas(JogoDetectiveQuest *jogo, const NoSala *sala) {
+    if (sala == NULL) return;
+    
+    recontarColetas(jogo, sala->esquerda);
+    recontarColetas(jogo, sala->direita);
+    
+    int suspeitos = jogo->caso->totalSuspeitos;
+    int *valores = jogo->coletadasSubarvore->valores;
+    int *linha = &valores[sala->id * suspeitos];
+    for (int s = 0; s < suspeitos; s++) {
+        linha[s] = 0;
+        if (sala->esquerda != NULL) linha[s] += valores[sala->esquerda->id * suspeitos + s];
+        if (sala->direita != NULL) linha[s] += valores[sala->direita->id * suspeitos + s];
+    }
+    if (sala->suspeito >= 0 && buscarPista(jogo->raizPistas, sala->pista)) {
+        linha[sala->suspeito]++;
+    }
+}
+
+/**
+ * registrarPistasRestauradas() - Em ordem: um evento por pista da versão restaurada
+ */
+static void registrarPistasRestauradas(DiarioSessao *diario, const NoPista *raiz) {
+    if (raiz == NULL) return;
+    
+    registrarPistasRestauradas(diario, raiz->esquerda);
+    registrarEvento(diario, EVENTO_PISTA_RESTAURADA, 0, 0, 0, raiz->pista);
+    registrarPistasRestauradas(diario, raiz->direita);
+}
+
+/**
+ * restaurarPistas() - Troca a versão atual por uma construída em lote
+ */
+int restaurarPistas(JogoDetectiveQuest *jogo, const char *const *pistasOrdenadas, int quantidade) {
+    if (jogo == NULL || !garantirColetasExclusivas(jogo)) return 0;
+    
+    int total = 0;
+    NoPista *raiz = construirPistasOrdenadas(pistasOrdenadas, quantidade, &total);
+    if (raiz == NULL && quantidade > 0) return 0;
+    
+    for (int i = 0; i < jogo->tamHistorico; i++) {
+        soltarPistas(jogo->historico[i].raizPistas);
+    }
+    jogo->tamHistorico = 0;
+    
+    soltarPistas(jogo->raizPistas);
+    jogo->raizPistas = raiz;
+    jogo->totalPistas = total;
+    
+    recontarColetas(jogo, jogo->caso->raizMansao);
+    
+    // O conjunto distinto é registrado para que o leitor possa reexecutar a restauração
+    if (jogo->diario != NULL) {
+        registrarEvento(jogo->diario, EVENTO_RESTAURACAO, 0, 0, (uint32_t)total, NULL);
+        registrarPistasRestauradas(jogo->diario, raiz);
+    }
+    return 1;
+}
+
+/**
+ * bifurcarJogo() - Copia rasa do jogo compartilhando a versão atual das pistas
+ */
+JogoDetectiveQuest *bifurcarJogo(const JogoDetectiveQuest *jogo) {
+    if (jogo == NULL) return NULL;
+    
+    JogoDetectiveQuest *copia = (JogoDetectiveQuest *)malloc(sizeof(JogoDetectiveQuest));
+    if (copia == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para jogo!\n");
+        return NULL;
+    }
+    
+    copia->caso = jogo->caso;
+    copia->raizPistas = reterPistas(jogo->raizPistas);
+    copia->totalPistas = jogo->totalPistas;
+    copia->historico = NULL;
+    copia->tamHistorico = 0;
+    copia->capHistorico = 0;
+    
+    // Contagens coletadas são estado do jogador: compartilhadas até a primeira escrita
+    copia->coletadasSubarvore = jogo->coletadasSubarvore;
+    copia->coletadasSubarvore->referencias++;
+    
+    // O diário tem um único produtor: a cópia não registra eventos
+    copia->diario = NULL;
+    copia->caso->referencias++;
+    
+    return copia;
 }
 
 // ============ IMPLEMENTAÇÃO: TABELA HASH ============
 
 /**
- * inicializarHash() - Cria e inicializa a tabela hash
+ * alocarEntradasHash() - Vetor de entradas livres
+ */
+static EntradaHash *alocarEntradasHash(int capacidade) {
+    EntradaHash *entradas = (EntradaHash *)calloc((size_t)capacidade, sizeof(EntradaHash));
+    if (entradas == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para tabela hash!\n");
+    }
+    return entradas;
+}
+
+/**
+ * inicializarHash() - Cria e inicializa a tabela hash com HASH_SIZE posições
  */
-EntradaHash *inicializarHash(void) {
-    EntradaHash *tabela = (EntradaHash *)malloc(sizeof(EntradaHash) * HASH_SIZE);
+TabelaHash *inicializarHash(void) {
+    TabelaHash *tabela = (TabelaHash *)malloc(sizeof(TabelaHash));
     if (tabela == NULL) {
         fprintf(stderr, "Erro ao alocar memória para tabela hash!\n");
         return NULL;
     }
     
-    for (int i = 0; i < HASH_SIZE; i++) {
-        tabela[i].ocupada = 0;
-        tabela[i].pista[0] = '\0';
-        tabela[i].suspeito[0] = '\0';
+    tabela->entradas = alocarEntradasHash(HASH_SIZE);
+    if (tabela->entradas == NULL) {
+        free(tabela);
+        return NULL;
     }
+    tabela->capacidade = HASH_SIZE;
+    tabela->ocupadas = 0;
     
     return tabela;
 }
 
 /**
- * hashFunction() - Função hash simples: soma dos ASCII dos caracteres
- * Módulo HASH_SIZE para obter índice válido
+ * hashFunction() - FNV-1a sobre os caracteres da chave
+ * Módulo capacidade para obter índice válido
  */
-int hashFunction(const char *chave) {
-    int hash = 0;
+int hashFunction(const char *chave, int capacidade) {
+    unsigned hash = 2166136261u;
     for (int i = 0; chave[i] != '\0'; i++) {
-        hash += (unsigned char)chave[i];
+        hash ^= (unsigned char)chave[i];
+        hash *= 16777619u;
+    }
+    return (int)(hash % (unsigned)capacidade);
+}
+
+/**
+ * redimensionarHash() - Move as entradas para um vetor de nova capacidade
+ * Os textos internados mudam de posição sem novas referências
+ */
+static int redimensionarHash(TabelaHash *tabela, int capacidade) {
+    EntradaHash *entradas = alocarEntradasHash(capacidade);
+    if (entradas == NULL) return 0;
+    
+    for (int i = 0; i < tabela->capacidade; i++) {
+        if (!tabela->entradas[i].ocupada) continue;
+        
+        int indice = hashFunction(tabela->entradas[i].pista, capacidade);
+        while (entradas[indice].ocupada) {
+            indice = (indice + 1) % capacidade;
+        }
+        entradas[indice] = tabela->entradas[i];
     }
-    return hash % HASH_SIZE;
+    
+    free(tabela->entradas);
+    tabela->entradas = entradas;
+    tabela->capacidade = capacidade;
+    return 1;
 }
 
+static int posicionarNaHash(TabelaHash *tabela, int indice, const char *pista, const char *suspeito);
+
 /**
  * inserirNaHash() - Insere pista -> suspeito com sondagem linear
- * Tratamento de colisão: se posição ocupada, tenta próxima
+ * Dobra a capacidade antes que a tabela passe da metade
  */
-void inserirNaHash(EntradaHash *tabela, const char *pista, const char *suspeito) {
+void inserirNaHash(TabelaHash *tabela, const char *pista, const char *suspeito) {
     if (tabela == NULL) return;
     
-    int indice = hashFunction(pista);
+    // Se não conseguir crescer, ainda tenta posicionar no espaço que resta
+    if ((tabela->ocupadas + 1) * 2 > tabela->capacidade) {
+        redimensionarHash(tabela, tabela->capacidade * 2);
+    }
+    
+    posicionarNaHash(tabela, hashFunction(pista, tabela->capacidade), pista, suspeito);
+}
+
+/**
+ * posicionarNaHash() - Sondagem linear a partir de um índice já calculado
+ * Retorna 1 se inseriu ou a chave já existia, 0 se não há espaço ou memória
+ */
+static int posicionarNaHash(TabelaHash *tabela, int indice, const char *pista, const char *suspeito) {
+    EntradaHash *entradas = tabela->entradas;
     int tentativas = 0;
     
     // Sondagem linear para tratar colisões
-    while (tabela[indice].ocupada && tentativas < HASH_SIZE) {
+    while (entradas[indice].ocupada && tentativas < tabela->capacidade) {
         // Verificar se chave já existe (evitar duplicata)
-        if (strcmp(tabela[indice].pista, pista) == 0) {
-            return;  // Já existe, não insere
+        if (strcmp(entradas[indice].pista, pista) == 0) {
+            return 1;  // Já existe, não insere
         }
-        indice = (indice + 1) % HASH_SIZE;
+        indice = (indice + 1) % tabela->capacidade;
         tentativas++;
     }
     
-    if (tentativas < HASH_SIZE) {
-        strncpy(tabela[indice].pista, pista, PISTA_LEN - 1);
-        tabela[indice].pista[PISTA_LEN - 1] = '\0';
+    if (tentativas < tabela->capacidade) {
+        entradas[indice].pista = internarTexto(pista, PISTA_LEN);
+        entradas[indice].suspeito = internarTexto(suspeito, SUSPEITO_LEN);
         
-        strncpy(tabela[indice].suspeito, suspeito, SUSPEITO_LEN - 1);
-        tabela[indice].suspeito[SUSPEITO_LEN - 1] = '\0';
+        if (entradas[indice].pista == NULL || entradas[indice].suspeito == NULL) {
+            liberarTexto(entradas[indice].pista);
+            liberarTexto(entradas[indice].suspeito);
+            entradas[indice].pista = NULL;
+            entradas[indice].suspeito = NULL;
+            return 0;
+        }
         
-        tabela[indice].ocupada = 1;
+        entradas[indice].ocupada = 1;
+        tabela->ocupadas++;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Fatia de chaves processada por uma thread de hash
+ */
+typedef struct {
+    const char *const *chaves;
+    int capacidade;
+    int *hashes;
+    int inicio;
+    int fim;
+} FatiaHash;
+
+/**
+ * calcularFatiaHash() - Corpo das threads de calcularHashesEmLote()
+ */
+static void *calcularFatiaHash(void *argumento) {
+    FatiaHash *fatia = (FatiaHash *)argumento;
+    for (int i = fatia->inicio; i < fatia->fim; i++) {
+        fatia->hashes[i] = hashFunction(fatia->chaves[i], fatia->capacidade);
+    }
+    return NULL;
+}
+
+/**
+ * calcularHashesEmLote() - Divide as chaves em fatias contíguas entre threads
+ */
+void calcularHashesEmLote(const char *const *chaves, int quantidade, int capacidade, int *hashes) {
+    FatiaHash fatias[MAX_THREADS_HASH];
+    pthread_t threads[MAX_THREADS_HASH];
+    int threadsCriadas = 0;
+    
+    int numFatias = quantidade >= LIMIAR_HASH_PARALELO ? MAX_THREADS_HASH : 1;
+    int porFatia = (quantidade + numFatias - 1) / numFatias;
+    
+    for (int t = 0; t < numFatias; t++) {
+        fatias[t].chaves = chaves;
+        fatias[t].capacidade = capacidade;
+        fatias[t].hashes = hashes;
+        fatias[t].inicio = t * porFatia < quantidade ? t * porFatia : quantidade;
+        fatias[t].fim = fatias[t].inicio + porFatia < quantidade ? fatias[t].inicio + porFatia : quantidade;
+    }
+    
+    // A fatia 0 fica com a thread atual; se uma thread falhar, calcula aqui mesmo
+    for (int t = 1; t < numFatias; t++) {
+        if (pthread_create(&threads[threadsCriadas], NULL, calcularFatiaHash, &fatias[t]) == 0) {
+            threadsCriadas++;
+        } else {
+            calcularFatiaHash(&fatias[t]);
+        }
+    }
+    calcularFatiaHash(&fatias[0]);
+    
+    for (int t = 0; t < threadsCriadas; t++) {
+        pthread_join(threads[t], NULL);
     }
 }
 
+/**
+ * inserirNaHashEmLote() - Dimensiona uma vez, calcula hashes e posiciona
+ */
+int inserirNaHashEmLote(TabelaHash *tabela, const char *const *pistas,
+                        const char *const *suspeitos, int quantidade) {
+    if (tabela == NULL || quantidade < 0) return 0;
+    if (quantidade == 0) return 1;
+    
+    if (quantidade > INT_MAX / 4 - tabela->ocupadas) {
+        fprintf(stderr, "Tabela hash não comporta %d associações!\n", quantidade);
+        return 0;
+    }
+    
+    // Menor potência de dois que mantém a ocupação em no máximo metade
+    int necessarias = 2 * (tabela->ocupadas + quantidade);
+    int capacidade = 1;
+    while (capacidade < necessarias) capacidade *= 2;
+    if (capacidade > tabela->capacidade && !redimensionarHash(tabela, capacidade)) {
+        return 0;
+    }
+    
+    int *hashes = (int *)malloc(sizeof(int) * (size_t)quantidade);
+    if (hashes == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para hashes!\n");
+        return 0;
+    }
+    calcularHashesEmLote(pistas, quantidade, tabela->capacidade, hashes);
+    
+    int sucesso = 1;
+    for (int i = 0; i < quantidade && sucesso; i++) {
+        sucesso = posicionarNaHash(tabela, hashes[i], pistas[i], suspeitos[i]);
+    }
+    
+    free(hashes);
+    return sucesso;
+}
+
 /**
  * encontrarSuspeito() - Busca suspeito por pista na hash
- * Usa sondagem linear para localizar a entrada
+ * Usa sondagem linear; sem remoções, uma posição livre encerra a busca
  */
-const char *encontrarSuspeito(EntradaHash *tabela, const char *pista) {
+const char *encontrarSuspeito(const TabelaHash *tabela, const char *pista) {
     if (tabela == NULL) return "DESCONHECIDO";
     
-    int indice = hashFunction(pista);
+    int indice = hashFunction(pista, tabela->capacidade);
     int tentativas = 0;
     
-    while (tentativas < HASH_SIZE) {
-        if (tabela[indice].ocupada && strcmp(tabela[indice].pista, pista) == 0) {
-            return tabela[indice].suspeito;
+    while (tentativas < tabela->capacidade && tabela->entradas[indice].ocupada) {
+        if (strcmp(tabela->entradas[indice].pista, pista) == 0) {
+            return tabela->entradas[indice].suspeito;
         }
-        indice = (indice + 1) % HASH_SIZE;
+        indice = (indice + 1) % tabela->capacidade;
         tentativas++;
     }
     
     return "DESCONHECIDO";
 }
 
+/**
+ * populaTabelaHash() - Define as associações pista -> suspeito
+ * Esta função pré-popula a tabela hash com as relações do jogo
+ */
+int populaTabelaHash(TabelaHash *tabela) {
+    static const char *const pistas[] = {
+        // Pistas apontando para Mordecai
+        "Porta principal arrombada - sinal de invasão",
+        "Cofre aberto e documentos espalhados",
+        "Contrato rasgado com nome de um suspeito",
+        // Pistas apontando para Isabela
+        "Faca sangrenta na pia da cozinha",
+        "Pegadas de bota na lama próximo à janela",
+        // Pistas apontando para Victor
+        "Taça de vinho vazia na mesa de centro",
+        "Joia valiosa encontrada embaixo da cama",
+        // Pistas apontando para Camila
+        "Livro de contabilidade com anotações suspeitas",
+        "Carta não enviada confessando um crime"
+    };
+    static const char *const suspeitos[] = {
+        "Mordecai", "Mordecai", "Mordecai",
+        "Isabela", "Isabela",
+        "Victor", "Victor",
+        "Camila", "Camila"
+    };
+    
+    return inserirNaHashEmLote(tabela, pistas, suspeitos, (int)(sizeof(pistas) / sizeof(pistas[0])));
+}
+
 /**
  * contarPistasPorSuspeito() - Conta pistas relacionadas a um suspeito
  * Recursivo: percorre toda BST comparando suspeitos via hash
  */
-int contarPistasPorSuspeito(EntradaHash *tabela, NoPista *pistas, const char *suspeito) {
+int contarPistasPorSuspeito(const TabelaHash *tabela, NoPista *pistas, const char *suspeito) {
     if (pistas == NULL) return 0;
     
     int count = 0;
@@ -267,16 +831,310 @@ int contarPistasPorSuspeito(EntradaHash *tabela, NoPista *pistas, const char *su
 }
 
 /**
- * liberarHash() - Libera memória da tabela hash
+ * liberarHash() - Libera memória da tabela hash e solta seus textos
  */
-void liberarHash(EntradaHash *tabela) {
+void liberarHash(TabelaHash *tabela) {
     if (tabela != NULL) {
+        for (int i = 0; i < tabela->capacidade; i++) {
+            if (tabela->entradas[i].ocupada) {
+                liberarTexto(tabela->entradas[i].pista);
+                liberarTexto(tabela->entradas[i].suspeito);
+            }
+        }
+        free(tabela->entradas);
         free(tabela);
     }
 }
 
+// ============ IMPLEMENTAÇÃO: CASOS ============
+
+/**
+ * carregarCaso() - Cria o caso, executa o carregador e anota evidências
+ */
+CasoDetective *carregarCaso(const char *nome, CarregadorCaso carregar) {
+    CasoDetective *caso = (CasoDetective *)calloc(1, sizeof(CasoDetective));
+    if (caso == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para caso!\n");
+        return NULL;
+    }
+    
+    strncpy(caso->nome, nome, SALA_LEN - 1);
+    caso->nome[SALA_LEN - 1] = '\0';
+    caso->referencias = 1;  // Referência do chamador
+    
+    caso->tabelaHash = inicializarHash();
+    if (caso->tabelaHash == NULL || !carregar(caso) || !anotarEvidencias(caso)) {
+        fprintf(stderr, "Erro ao carregar caso %s!\n", caso->nome);
+        liberarCaso(caso);
+        return NULL;
+    }
+    
+    // Textos ficam no pool compartilhado e são contabilizados à parte
+    caso->memoria = sizeof(CasoDetective)
+                  + sizeof(NoSala) * (size_t)caso->totalSalas
+                  + sizeof(const char *) * (size_t)caso->capSuspeitos
+                  + sizeof(int) * (size_t)caso->totalSalas * (size_t)caso->totalSuspeitos
+                  + sizeof(TabelaHash)
+                  + sizeof(EntradaHash) * (size_t)caso->tabelaHash->capacidade;
+    
+    return caso;
+}
+
+/**
+ * carregarCasoMansao() - Mansão fixa e relações pista -> suspeito do jogo original
+ */
+int carregarCasoMansao(CasoDetective *caso) {
+    caso->raizMansao = construirMansao();
+    if (caso->raizMansao == NULL) return 0;
+    
+    return populaTabelaHash(caso->tabelaHash);
+}
+
+/**
+ * soltarCaso() - Avulsos são liberados; casos de registro ficam ociosos
+ */
+void soltarCaso(CasoDetective *caso) {
+    if (caso == NULL || --caso->referencias > 0) return;
+    
+    if (caso->registro == NULL) {
+        liberarCaso(caso);
+    } else {
+        // Caso ocioso pode ser despejado se o registro estiver acima do orçamento
+        aplicarOrcamentoRegistro(caso->registro);
+    }
+}
+
+/**
+ * liberarCaso() - Libera as estruturas do caso e solta seus textos
+ */
+void liberarCaso(CasoDetective *caso) {
+    if (caso == NULL) return;
+    
+    liberarSalas(caso->raizMansao);
+    liberarHash(caso->tabelaHash);
+    for (int i = 0; i < caso->totalSuspeitos; i++) {
+        liberarTexto(caso->suspeitos[i]);
+    }
+    free(caso->suspeitos);
+    free(caso->pistasSubarvore);
+    free(caso);
+}
+
+// ============ IMPLEMENTAÇÃO: AGREGADOS DE EVIDÊNCIA ============
+
+/**
+ * indiceSuspeito() - Busca linear na lista (poucos suspeitos por caso)
+ */
+int indiceSuspeito(const CasoDetective *caso, const char *suspeito) {
+    if (caso == NULL || suspeito == NULL) return -1;
+    
+    for (int i = 0; i < caso->totalSuspeitos; i++) {
+        if (strcmp(caso->suspeitos[i], suspeito) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * registrarSuspeito() - Retorna o índice do suspeito, registrando-o se novo
+ * -1 para pista sem suspeito; -2 se falta memória
+ */
+static int registrarSuspeito(CasoDetective *caso, const char *suspeito) {
+    if (strcmp(suspeito, "DESCONHECIDO") == 0) return -1;
+    
+    int indice = indiceSuspeito(caso, suspeito);
+    if (indice >= 0) return indice;
+    
+    // Crescimento geométrico: a lista é montada uma vez por carga
+    if (caso->totalSuspeitos == caso->capSuspeitos) {
+        int novaCap = caso->capSuspeitos > 0 ? caso->capSuspeitos * 2 : 8;
+        const char **novos = (const char **)realloc((void *)caso->suspeitos, sizeof(const char *) * (size_t)novaCap);
+        if (novos == NULL) {
+            fprintf(stderr, "Erro ao alocar memória para suspeitos!\n");
+            return -2;
+        }
+        caso->suspeitos = novos;
+        caso->capSuspeitos = novaCap;
+    }
+    
+    const char *internado = internarTexto(suspeito, SUSPEITO_LEN);
+    if (internado == NULL) return -2;
+    
+    caso->suspeitos[caso->totalSuspeitos] = internado;
+    return caso->totalSuspeitos++;
+}
+
+/**
+ * anotarSalas() - Pré-ordem: pai, id e suspeito de cada sala
+ * Retorna 0 se algum suspeito não pôde ser registrado
+ */
+static int anotarSalas(CasoDetective *caso, NoSala *no, NoSala *pai) {
+    if (no == NULL) return 1;
+    
+    no->pai = pai;
+    no->id = caso->totalSalas++;
+    no->suspeito = registrarSuspeito(caso, encontrarSuspeito(caso->tabelaHash, no->pista));
+    if (no->suspeito == -2) return 0;
+    
+    return anotarSalas(caso, no->esquerda, no) && anotarSalas(caso, no->direita, no);
+}
+
+/**
+ * somarSubarvore() - Postorder: soma as linhas dos filhos à pista da sala
+ */
+static void somarSubarvore(CasoDetective *caso, const NoSala *no) {
+    if (no == NULL) return;
+    
+    somarSubarvore(caso, no->esquerda);
+    somarSubarvore(caso, no->direita);
+    
+    int suspeitos = caso->totalSuspeitos;
+    int *linha = &caso->pistasSubarvore[no->id * suspeitos];
+    for (int s = 0; s < suspeitos; s++) {
+        linha[s] = 0;
+        if (no->esquerda != NULL) linha[s] += caso->pistasSubarvore[no->esquerda->id * suspeitos + s];
+        if (no->direita != NULL) linha[s] += caso->pistasSubarvore[no->direita->id * suspeitos + s];
+    }
+    if (no->suspeito >= 0) {
+        linha[no->suspeito]++;
+    }
+}
+
+/**
+ * anotarEvidencias() - Passo único de anotação ao carregar o caso
+ */
+int anotarEvidencias(CasoDetective *caso) {
+    if (caso == NULL) return 0;
+    
+    for (int i = 0; i < caso->totalSuspeitos; i++) {
+        liberarTexto(caso->suspeitos[i]);
+    }
+    caso->totalSuspeitos = 0;
+    caso->totalSalas = 0;
+    free(caso->pistasSubarvore);
+    caso->pistasSubarvore = NULL;
+    
+    if (!anotarSalas(caso, caso->raizMansao, NULL)) return 0;
+    
+    size_t celulas = (size_t)caso->totalSalas * (size_t)caso->totalSuspeitos;
+    if (celulas > 0) {
+        caso->pistasSubarvore = (int *)malloc(sizeof(int) * celulas);
+        if (caso->pistasSubarvore == NULL) {
+            fprintf(stderr, "Erro ao alocar memória para agregados!\n");
+            return 0;
+        }
+        somarSubarvore(caso, caso->raizMansao);
+    }
+    return 1;
+}
+
+/**
+ * criarColetas() - Bloco exclusivo com contagens zeradas ou copiadas de origem
+ */
+static ContagemColetas *criarColetas(const CasoDetective *caso, const ContagemColetas *origem) {
+    size_t celulas = (size_t)caso->totalSalas * (size_t)caso->totalSuspeitos;
+    ContagemColetas *coletas = (ContagemColetas *)malloc(sizeof(ContagemColetas) + sizeof(int) * celulas);
+    if (coletas == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para agregados!\n");
+        return NULL;
+    }
+    
+    coletas->referencias = 1;
+    if (origem != NULL) memcpy(coletas->valores, origem->valores, sizeof(int) * celulas);
+    else memset(coletas->valores, 0, sizeof(int) * celulas);
+    return coletas;
+}
+
+/**
+ * soltarColetas() - Libera o bloco quando o último jogo o solta
+ */
+static void soltarColetas(ContagemColetas *coletas) {
+    if (coletas != NULL && --coletas->referencias == 0) {
+        free(coletas);
+    }
+}
+
+/**
+ * garantirColetasExclusivas() - Cópia na escrita: copia o bloco se outro jogo o compartilha
+ * Retorna 0 em falha de alocação (contagens intactas)
+ */
+static int garantirColetasExclusivas(JogoDetectiveQuest *jogo) {
+    if (jogo->coletadasSubarvore->referencias == 1) return 1;
+    
+    ContagemColetas *copia = criarColetas(jogo->caso, jogo->coletadasSubarvore);
+    if (copia == NULL) return 0;
+    
+    jogo->coletadasSubarvore->referencias--;
+    jogo->coletadasSubarvore = copia;
+    return 1;
+}
+
+/**
+ * registrarColeta() - Atualiza incrementalmente a sala e seus ancestrais
+ * delta = +1 ao coletar a pista da sala, -1 ao desfazer a coleta
+ * O chamador garante antes um bloco exclusivo (garantirColetasExclusivas())
+ */
+static void registrarColeta(JogoDetectiveQuest *jogo, const NoSala *sala, int delta) {
+    if (sala == NULL || sala->suspeito < 0) return;
+    
+    for (const NoSala *atual = sala; atual != NULL; atual = atual->pai) {
+        jogo->coletadasSubarvore->valores[atual->id * jogo->caso->totalSuspeitos + sala->suspeito] += delta;
+    }
+}
+
+/**
+ * pistasRestantesNaSubarvore() - Total anotado menos o já coletado
+ */
+int pistasRestantesNaSubarvore(const JogoDetectiveQuest *jogo, const NoSala *sala, int suspeito) {
+    if (jogo == NULL || sala == NULL || suspeito < 0 || suspeito >= jogo->caso->totalSuspeitos) return 0;
+    
+    int indice = sala->id * jogo->caso->totalSuspeitos + suspeito;
+    return jogo->caso->pistasSubarvore[indice] - jogo->coletadasSubarvore->valores[indice];
+}
+
+/**
+ * condenacaoPossivel() - Coletadas (agregado da raiz) + restantes na subárvore
+ */
+int condenacaoPossivel(const JogoDetectiveQuest *jogo, const NoSala *sala) {
+    if (jogo == NULL || sala == NULL) return 1;
+    
+    const int *coletadasTotal = &jogo->coletadasSubarvore->valores[jogo->caso->raizMansao->id * jogo->caso->totalSuspeitos];
+    
+    for (int s = 0; s < jogo->caso->totalSuspeitos; s++) {
+        if (coletadasTotal[s] + pistasRestantesNaSubarvore(jogo, sala, s) >= MIN_PISTAS_ACUSACAO) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 // ============ IMPLEMENTAÇÃO: EXPLORAÇÃO ============
 
+/**
+ * coletarPista() - Insere a pista da sala como nova versão persistente
+ */
+int coletarPista(JogoDetectiveQuest *jogo, NoSala *sala) {
+    uint64_t inicio = inicioFase();
+    int jaColetada = buscarPista(jogo->raizPistas, sala->pista);
+    fimFase(FASE_BUSCA_PISTA, inicio);
+    if (jaColetada) return 0;
+    if (!garantirColetasExclusivas(jogo)) return 0;
+    
+    inicio = inicioFase();
+    NoPista *novaVersao = inserirPistaPersistente(jogo->raizPistas, sala->pista);
+    if (novaVersao == NULL) return 0;
+    
+    soltarPistas(jogo->raizPistas);
+    jogo->raizPistas = novaVersao;
+    jogo->totalPistas++;
+    registrarColeta(jogo, sala, +1);
+    if (jogo->tamHistorico > 0) {
+        jogo->historico[jogo->tamHistorico - 1].salaColetada = sala;
+    }
+    fimFase(FASE_INSERCAO_PISTA, inicio);
+    registrarEvento(jogo->diario, EVENTO_PISTA, 0, (uint16_t)sala->id, 0, NULL);
+    return 1;
+}
+
 /**
  * explorarSalas() - Exploração interativa da mansão
  * Navega a árvore binária com escolhas do jogador (e/d/s)
@@ -288,46 +1146,98 @@ int explorarSalas(NoSala *no, JogoDetectiveQuest *jogo) {
         return 1;  // Continua no jogo
     }
     
+    uint64_t inicioTurno = inicioFase();
+    uint64_t inicio = inicioFase();
     exibirSala(no);
+    fimFase(FASE_RENDERIZACAO, inicio);
     
-    // Adicionar pista se ainda não coletada
-    if (!buscarPista(jogo->raizPistas, no->pista)) {
+    // Adicionar pista se ainda não coletada (nova versão, anteriores intactas)
+    if (coletarPista(jogo, no)) {
         printf("[NOVA PISTA COLETADA]\n");
-        jogo->raizPistas = inserirPista(jogo->raizPistas, no->pista);
-        jogo->totalPistas++;
     } else {
         printf("[Pista já coletada anteriormente]\n");
     }
     
+    if (!condenacaoPossivel(jogo, no)) {
+        printf("[DICA] Nenhum suspeito pode mais ser condenado seguindo por aqui.\n");
+    }
+    
     char opcao;
     printf("Sua escolha: ");
+    inicio = inicioFase();
     scanf(" %c", &opcao);
+    uint64_t espera = fimFase(FASE_LEITURA_ENTRADA, inicio);
     opcao = tolower(opcao);
     
+    inicio = inicioFase();
+    NoSala *destino = NULL;
+    if (opcao == 'e') destino = no->esquerda;
+    else if (opcao == 'd') destino = no->direita;
+    fimFase(FASE_BUSCA_SALA, inicio);
+    
+    NoSala *seguinte = no;  // Sala do próximo turno (a mesma se a ação não se completar)
+    int retorno = -1;       // >= 0: encerra a exploração desta sala com este valor
+    
     switch (opcao) {
         case 'e':
-            if (no->esquerda != NULL) {
-                printf("\n--- Você se move para a esquerda ---\n");
-                return explorarSalas(no->esquerda, jogo);
-            } else {
-                printf("\nNão há caminho à esquerda!\n");
-                return explorarSalas(no, jogo);
+        case 'd': {
+            if (destino == NULL) {
+                printf("\nNão há caminho à %s!\n", opcao == 'e' ? "esquerda" : "direita");
+                break;
+            }
+            
+            // Snapshot O(1) antes de mover: sem ele o desfazer perderia o par com a recursão
+            inicio = inicioFase();
+            int salvo = salvarVersaoPistas(jogo);
+            if (salvo) {
+                registrarEvento(jogo->diario, EVENTO_MOVIMENTO, (uint8_t)opcao, (uint16_t)destino->id, 0, NULL);
+            }
+            fimFase(FASE_REGISTRO, inicio);
+            
+            if (!salvo) {
+                printf("\nNão foi possível registrar o movimento. Tente novamente.\n");
+                break;
             }
-        case 'd':
-            if (no->direita != NULL) {
-                printf("\n--- Você se move para a direita ---\n");
-                return explorarSalas(no->direita, jogo);
-            } else {
-                printf("\nNão há caminho à direita!\n");
-                return explorarSalas(no, jogo);
+            printf("\n--- Você se move para a %s ---\n", opcao == 'e' ? "esquerda" : "direita");
+            seguinte = destino;
+            break;
+        }
+        case 'v': {
+            inicio = inicioFase();
+            int desfeito = desfazerVersaoPistas(jogo);
+            if (desfeito) {
+                registrarEvento(jogo->diario, EVENTO_DESFAZER, 0, (uint16_t)no->id, 0, NULL);
+            }
+            fimFase(FASE_REGISTRO, inicio);
+            
+            if (!desfeito) {
+                printf("\nNão há movimento para desfazer!\n");
+                break;
             }
+            printf("\n--- Você volta para a sala anterior ---\n");
+            retorno = EXPLORACAO_DESFEITA;
+            break;
+        }
         case 's':
             printf("\n--- Você sai da mansão para fazer sua acusação ---\n");
-            return 0;  // Sai do jogo
+            retorno = 0;  // Sai do jogo
+            break;
         default:
             printf("Opção inválida! Tente novamente.\n");
-            return explorarSalas(no, jogo);
+            break;
     }
+    
+    // O turno termina após o registro da ação; a espera pela entrada não conta
+    fimFaseDescontando(FASE_TURNO, inicioTurno, espera);
+    
+    if (retorno >= 0) return retorno;
+    if (seguinte == no) return explorarSalas(no, jogo);
+    
+    int resultado = explorarSalas(seguinte, jogo);
+    if (resultado == EXPLORACAO_DESFEITA) {
+        return explorarSalas(no, jogo);
+    }
+    return resultado;
 }
 
 // ============ IMPLEMENTAÇÃO: JULGAMENTO FINAL ============
@@ -336,7 +1246,7 @@ int explorarSalas(NoSala *no, JogoDetectiveQuest *jogo) {
  * verificarSuspeitoFinal() - Sistema de acusação final
  * Valida se há pistas suficientes (mínimo 2) para o suspeito acusado
  */
-int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, EntradaHash *tabela) {
+int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, const TabelaHash *tabela) {
     printf("\n========================================\n");
     printf("PHASE FINAL: ACUSAÇÃO\n");
     printf("========================================\n");
@@ -354,7 +1264,9 @@ int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, EntradaHash *tabela) {
     
     char suspeito[SUSPEITO_LEN];
     printf("\nEm quem você acusa? ");
+    uint64_t inicio = inicioFase();
     fgets(suspeito, SUSPEITO_LEN, stdin);
+    fimFase(FASE_LEITURA_ENTRADA, inicio);
     
     // Remove quebra de linha
     size_t len = strlen(suspeito);
@@ -363,9 +1275,13 @@ int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, EntradaHash *tabela) {
     }
     
     // Contar pistas relacionadas ao suspeito
+    inicio = inicioFase();
     int pistasSuspeito = contarPistasPorSuspeito(tabela, jogo->raizPistas, suspeito);
+    fimFase(FASE_ACUSACAO, inicio);
     
-    int acertou = (pistasSuspeito >= 2);
+    int acertou = (pistasSuspeito >= MIN_PISTAS_ACUSACAO);
+    registrarEvento(jogo->diario, EVENTO_ACUSACAO, (uint8_t)acertou, 0,
+                    (uint32_t)pistasSuspeito, suspeito);
     exibirResultadoFinal(acertou, suspeito, pistasSuspeito);
     
     return acertou;
@@ -399,36 +1315,52 @@ void exibirResultadoFinal(int acertou, const char *suspeito, int pistasSuspeito)
 // ============ IMPLEMENTAÇÃO: INICIALIZAÇÃO E LIMPEZA ============
 
 /**
- * inicializarJogo() - Prepara todas as estruturas do jogo
+ * inicializarJogo() - Prepara o estado de um jogador para o caso
  */
-JogoDetectiveQuest *inicializarJogo(void) {
+JogoDetectiveQuest *inicializarJogo(CasoDetective *caso) {
+    if (caso == NULL) return NULL;
+    
     JogoDetectiveQuest *jogo = (JogoDetectiveQuest *)malloc(sizeof(JogoDetectiveQuest));
     if (jogo == NULL) {
         fprintf(stderr, "Erro ao alocar memória para jogo!\n");
         return NULL;
     }
     
-    jogo->raizMansao = construirMansao();
+    jogo->coletadasSubarvore = criarColetas(caso, NULL);
+    if (jogo->coletadasSubarvore == NULL) {
+        free(jogo);
+        return NULL;
+    }
+    
+    jogo->caso = caso;
     jogo->raizPistas = NULL;
-    jogo->tabelaHash = inicializarHash();
     jogo->totalPistas = 0;
+    jogo->historico = NULL;
+    jogo->tamHistorico = 0;
+    jogo->capHistorico = 0;
+    jogo->diario = NULL;
+    caso->referencias++;
     
     return jogo;
 }
 
 /**
- * liberarJogo() - Libera toda memória alocada
+ * liberarJogo() - Libera o estado do jogador e solta o caso
  */
 void liberarJogo(JogoDetectiveQuest *jogo) {
     if (jogo == NULL) return;
     
-    // Liberar mansão recursivamente
-    if (jogo->raizMansao != NULL) {
-        // Função auxiliar necessária (implementada abaixo)
+    // Soltar versões do histórico e a versão atual
+    for (int i = 0; i < jogo->tamHistorico; i++) {
+        soltarPistas(jogo->historico[i].raizPistas);
     }
+    free(jogo->historico);
+    soltarColetas(jogo->coletadasSubarvore);
+    fecharDiario(jogo->diario);
+    soltarPistas(jogo->raizPistas);
     
-    liberarPistas(jogo->raizPistas);
-    liberarHash(jogo->tabelaHash);
+    // A mansão e a hash pertencem ao caso, compartilhado entre jogos
+    soltarCaso(jogo->caso);
     free(jogo);
 }
 
@@ -459,6 +1391,7 @@ void exibirMenu(void) {
     printf("CONTROLES:\n");
     printf("  [e] - Explorar sala à esquerda\n");
     printf("  [d] - Explorar sala à direita\n");
+    printf("  [v] - Voltar e desfazer o último movimento\n");
     printf("  [s] - Sair da mansão e fazer acusação\n");
     printf("\n");
     printf("Que comece a investigação!\n");
@@ -474,5 +1407,7 @@ void liberarSalas(NoSala *raiz) {
     if (raiz == NULL) return;
     liberarSalas(raiz->esquerda);
     liberarSalas(raiz->direita);
+    liberarTexto(raiz->nome);
+    liberarTexto(raiz->pista);
     free(raiz);
 }
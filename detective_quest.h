@@ -11,22 +11,31 @@
 #include <string.h>
 #include <ctype.h>
 
+#include "diario_sessao.h"
+
 #define PISTA_LEN 100
 #define SUSPEITO_LEN 50
 #define SALA_LEN 50
 #define MAX_PISTAS 100
-#define HASH_SIZE 50
+#define HASH_SIZE 50  // Capacidade inicial da tabela hash
+#define MIN_PISTAS_ACUSACAO 2
+#define TEXTOS_BUCKETS 1024
+#define LIMIAR_HASH_PARALELO 4096  // Chaves a partir das quais o hash em lote usa threads
+#define MAX_THREADS_HASH 4
 
 // ============ ESTRUTURAS DE DADOS ============
 
 /**
  * Nó da árvore binária de pistas (BST)
  * Armazena pistas em ordem alfabética
+ * Nós podem ser compartilhados entre versões (contagem de referências)
  */
 typedef struct NoPista {
     char pista[PISTA_LEN];
     struct NoPista *esquerda;
     struct NoPista *direita;
+    int referencias;  // Quantas versões/pais apontam para este nó
+    struct BlocoPistas *bloco;  // Bloco da construção em lote (NULL se alocado sozinho)
 } NoPista;
 
 /**
@@ -34,31 +43,96 @@ typedef struct NoPista {
  * Permite busca eficiente de suspeitos por pista
  */
 typedef struct EntradaHash {
-    char pista[PISTA_LEN];
-    char suspeito[SUSPEITO_LEN];
+    const char *pista;     // Texto internado (ver internarTexto())
+    const char *suspeito;  // Texto internado
     int ocupada;  // Flag para verificar se a posição está ocupada
 } EntradaHash;
 
+/**
+ * Tabela hash pista -> suspeito com sondagem linear
+ * A capacidade acompanha o vetor: cresce ao inserir e é pré-dimensionada em lote
+ */
+typedef struct {
+    EntradaHash *entradas;
+    int capacidade;  // Posições alocadas
+    int ocupadas;    // Posições em uso
+} TabelaHash;
+
 /**
  * Nó da árvore binária de salas (estrutura da mansão)
  * Cada sala contém um nome, pista e referências para salas adjacentes
+ * Nome e pista são textos internados, compartilhados entre casos
  */
 typedef struct NoSala {
-    char nome[SALA_LEN];
-    char pista[PISTA_LEN];
+    const char *nome;
+    const char *pista;
     struct NoSala *esquerda;   // Sala à esquerda
     struct NoSala *direita;    // Sala à direita
+    struct NoSala *pai;        // Sala de onde se chega a esta (NULL na raiz)
+    int id;                    // Índice em pré-ordem, atribuído por anotarEvidencias()
+    int suspeito;              // Índice do suspeito da pista (-1 se desconhecido)
 } NoSala;
 
 /**
- * Estrutura principal do jogo
- * Contém a mansão, pistas coletadas e tabela de suspeitos
+ * Versão imutável do conjunto de pistas
+ * Guarda a raiz de uma BST persistente e o total de pistas naquele momento
+ */
+typedef struct {
+    NoPista *raizPistas;
+    int totalPistas;
+    NoSala *salaColetada;  // Sala cuja pista foi coletada após esta versão
+} VersaoPistas;
+
+struct RegistroCasos;
+
+/**
+ * Caso carregado: dados imutáveis compartilhados por todos os jogadores
+ * Mansão, tabela pista -> suspeito e anotações de evidência
+ */
+typedef struct CasoDetective {
+    char nome[SALA_LEN];              // Identificador do caso
+    NoSala *raizMansao;               // Raiz da árvore de salas
+    TabelaHash *tabelaHash;           // Tabela hash pista -> suspeito
+    const char **suspeitos;           // Suspeitos conhecidos (internados)
+    int totalSuspeitos;               // Quantidade de suspeitos conhecidos
+    int capSuspeitos;                 // Capacidade alocada de suspeitos
+    int *pistasSubarvore;             // [sala][suspeito] pistas anotadas na subárvore
+    int totalSalas;                   // Quantidade de salas anotadas
+    size_t memoria;                   // Bytes das estruturas próprias do caso
+    int referencias;                  // Jogos usando o caso
+    struct RegistroCasos *registro;   // Registro dono (NULL se avulso)
+    struct CasoDetective *anterior;   // Lista LRU do registro (mais recente)
+    struct CasoDetective *proximo;    // Lista LRU do registro (menos recente)
+} CasoDetective;
+
+/**
+ * Função que preenche mansão e tabela hash de um caso recém-criado
+ * Retorna 1 se sucesso, 0 em erro
+ */
+typedef int (*CarregadorCaso)(CasoDetective *caso);
+
+/**
+ * Contagens de pistas coletadas por sala e suspeito
+ * Compartilhadas entre jogos bifurcados até a primeira escrita (cópia na escrita)
+ */
+typedef struct {
+    int referencias;  // Jogos que compartilham este bloco
+    int valores[];    // [sala][suspeito], mesmo formato de CasoDetective.pistasSubarvore
+} ContagemColetas;
+
+/**
+ * Estrutura principal do jogo (estado de um jogador)
+ * Referencia um caso compartilhado e guarda as pistas coletadas
  */
 typedef struct {
-    NoSala *raizMansao;          // Raiz da árvore de salas
+    CasoDetective *caso;         // Caso em jogo (mansão e suspeitos)
     NoPista *raizPistas;         // Raiz da BST de pistas coletadas
-    EntradaHash *tabelaHash;     // Tabela hash pista -> suspeito
     int totalPistas;             // Contador de pistas coletadas
+    VersaoPistas *historico;     // Pilha de versões anteriores (desfazer)
+    int tamHistorico;            // Versões empilhadas
+    int capHistorico;            // Capacidade alocada da pilha
+    ContagemColetas *coletadasSubarvore;  // Pistas já coletadas por sala e suspeito
+    DiarioSessao *diario;        // Diário de eventos (NULL se desativado)
 } JogoDetectiveQuest;
 
 // ============ FUNÇÕES DE GERENCIAMENTO DE SALAS ============
@@ -84,22 +158,98 @@ NoSala *criarSala(const char *nome, const char *pista);
  */
 NoSala *construirMansao(void);
 
+/**
+ * liberarSalas() - Libera recursivamente a árvore de salas e seus textos
+ */
+void liberarSalas(NoSala *raiz);
+
+// ============ FUNÇÕES DE POOL DE TEXTOS ============
+
+/**
+ * internarTexto() - Retorna a cópia compartilhada de um texto
+ *
+ * Textos iguais (após truncar em limite - 1 caracteres) usados por
+ * vários casos são armazenados uma única vez, com contagem de referências.
+ * Cada chamada deve ser pareada com liberarTexto().
+ *
+ * @param texto: Texto a internar
+ * @param limite: Tamanho máximo, incluindo o '\0' (ex.: PISTA_LEN)
+ * @return: Ponteiro estável para o texto internado, ou NULL em falha de alocação
+ */
+const char *internarTexto(const char *texto, size_t limite);
+
+/**
+ * liberarTexto() - Solta uma referência a um texto internado
+ */
+void liberarTexto(const char *texto);
+
+/**
+ * bytesTextosInternados() - Memória ocupada atualmente pelo pool de textos
+ */
+size_t bytesTextosInternados(void);
+
+// ============ FUNÇÕES DE CASO ============
+
+/**
+ * carregarCaso() - Cria um caso avulso usando um carregador
+ *
+ * Cria a tabela hash, chama o carregador e anota as evidências.
+ * O caso começa com a referência do chamador, que deve soltá-la com
+ * soltarCaso(); cada jogo criado com inicializarJogo() retém a sua.
+ *
+ * @param nome: Identificador do caso
+ * @param carregar: Função que monta mansão e tabela hash
+ * @return: Caso carregado ou NULL em erro
+ */
+CasoDetective *carregarCaso(const char *nome, CarregadorCaso carregar);
+
+/**
+ * carregarCasoMansao() - Carregador do caso padrão "O Mistério da Mansão Escura"
+ */
+int carregarCasoMansao(CasoDetective *caso);
+
+/**
+ * soltarCaso() - Solta uma referência ao caso
+ *
+ * Casos avulsos são liberados sem referências; casos de um registro
+ * permanecem residentes até serem despejados (ver registro_casos.h).
+ */
+void soltarCaso(CasoDetective *caso);
+
+/**
+ * liberarCaso() - Libera mansão, tabela hash e textos do caso
+ */
+void liberarCaso(CasoDetective *caso);
+
 // ============ FUNÇÕES DE EXPLORAÇÃO ============
 
+#define EXPLORACAO_DESFEITA 2  // Retorno de explorarSalas() quando o jogador volta
+
 /**
  * explorarSalas() - Navega pela árvore e ativa o sistema de pistas
  *
  * Implementa uma exploração interativa do jogo. O jogador navega
- * pelos cômodos escolhendo ir para esquerda (e), direita (d) ou sair (s).
+ * pelos cômodos escolhendo ir para esquerda (e), direita (d), voltar (v)
+ * desfazendo o último movimento, ou sair (s).
  * Ao visitar uma sala, a pista é exibida e coletada automaticamente.
  * A função usa recursividade para navegar pela árvore binária.
  *
  * @param no: Nó atual da árvore (sala atual)
  * @param jogo: Estrutura do jogo para armazenar pistas coletadas
- * @return: 1 se continuando, 0 se o jogador saiu
+ * @return: 1 se continuando, 0 se o jogador saiu, EXPLORACAO_DESFEITA se voltou
  */
 int explorarSalas(NoSala *no, JogoDetectiveQuest *jogo);
 
+/**
+ * coletarPista() - Coleta a pista da sala se ainda não estiver na BST
+ *
+ * Cria uma nova versão persistente das pistas, atualiza os agregados de
+ * evidência e registra EVENTO_PISTA no diário.
+ *
+ * @return: 1 se a pista era nova, 0 caso contrário
+ */
+int coletarPista(JogoDetectiveQuest *jogo, NoSala *sala);
+
 /**
  * exibirSala() - Exibe informações da sala atual e sua pista
  */
@@ -143,20 +293,103 @@ int contarPistas(NoPista *raiz);
 
 /**
  * liberarPistas() - Libera memória da BST de pistas
+ * Apenas para árvores não compartilhadas; versões persistentes usam soltarPistas()
  */
 void liberarPistas(NoPista *raiz);
 
+// ============ FUNÇÕES DE PISTAS PERSISTENTES ============
+
+/**
+ * inserirPistaPersistente() - Insere pista criando uma nova versão da BST
+ *
+ * Copia apenas o caminho da raiz até o ponto de inserção (O(log n) nós);
+ * as demais subárvores são compartilhadas com a versão original, que
+ * permanece intacta. Se a pista já existe (em qualquer profundidade),
+ * nenhum nó é alocado e a própria raiz é retornada retida.
+ *
+ * @param raiz: Raiz da versão original (não é modificada)
+ * @param pista: Texto da pista a ser inserida
+ * @return: Nova referência para a raiz da nova versão, ou NULL em falha de alocação
+ */
+NoPista *inserirPistaPersistente(NoPista *raiz, const char *pista);
+
+/**
+ * construirPistasOrdenadas() - Constrói uma BST perfeitamente balanceada em O(n)
+ *
+ * Todos os nós vêm de uma única alocação, liberada quando o último nó
+ * do bloco é solto. A árvore é uma versão persistente comum: aceita
+ * inserirPistaPersistente(), reterPistas() e soltarPistas().
+ *
+ * @param pistas: Pistas em ordem crescente (strcmp); repetidas adjacentes são ignoradas
+ * @param quantidade: Número de pistas no vetor
+ * @param total: Saída opcional com o número de pistas distintas
+ * @return: Raiz da nova versão, ou NULL se vazia, fora de ordem ou em falha de alocação
+ */
+NoPista *construirPistasOrdenadas(const char *const *pistas, int quantidade, int *total);
+
+/**
+ * reterPistas() - Registra mais uma referência a uma versão (O(1))
+ */
+NoPista *reterPistas(NoPista *raiz);
+
+/**
+ * soltarPistas() - Libera uma referência; nós sem referências são liberados
+ */
+void soltarPistas(NoPista *raiz);
+
+/**
+ * salvarVersaoPistas() - Empilha a versão atual das pistas (snapshot O(1))
+ *
+ * @return: 1 se a versão foi salva, 0 em falha de alocação
+ */
+int salvarVersaoPistas(JogoDetectiveQuest *jogo);
+
+/**
+ * desfazerVersaoPistas() - Restaura a última versão empilhada
+ *
+ * @return: 1 se houve desfazer, 0 se o histórico está vazio
+ */
+int desfazerVersaoPistas(JogoDetectiveQuest *jogo);
+
+/**
+ * restaurarPistas() - Substitui as pistas do jogador por um conjunto ordenado
+ *
+ * Usa construirPistasOrdenadas() e recalcula os agregados de evidência
+ * em uma única passada pós-ordem pela mansão (cada sala soma as linhas
+ * dos filhos e a própria coleta). O histórico de desfazer é descartado:
+ * a versão restaurada passa a ser a base da sessão. Com diário aberto,
+ * registra EVENTO_RESTAURACAO seguido de uma EVENTO_PISTA_RESTAURADA por
+ * pista distinta, em ordem.
+ *
+ * @return: 1 se restaurado, 0 em erro (estado anterior preservado)
+ */
+int restaurarPistas(JogoDetectiveQuest *jogo, const char *const *pistasOrdenadas, int quantidade);
+
+/**
+ * bifurcarJogo() - Cria uma cópia independente do estado do jogador em O(1)
+ *
+ * A cópia compartilha o caso, a BST de pistas atual e as contagens
+ * coletadas (por referência) e começa com histórico vazio. Inserções em
+ * qualquer um dos jogos não afetam o outro: a primeira coleta, desfazer
+ * ou restauração de cada jogo copia as contagens compartilhadas, em
+ * O(salas * suspeitos). A cópia não grava no diário do original.
+ *
+ * @param jogo: Jogo original
+ * @return: Novo jogo, liberado com liberarJogo() em qualquer ordem
+ */
+JogoDetectiveQuest *bifurcarJogo(const JogoDetectiveQuest *jogo);
+
 // ============ FUNÇÕES DE TABELA HASH ============
 
 /**
- * inicializarHash() - Inicializa a tabela hash
+ * inicializarHash() - Inicializa a tabela hash com HASH_SIZE posições
  */
-EntradaHash *inicializarHash(void);
+TabelaHash *inicializarHash(void);
 
 /**
- * hashFunction() - Função de hash simples (soma dos caracteres módulo HASH_SIZE)
+ * hashFunction() - Função de hash FNV-1a módulo a capacidade da tabela
  */
-int hashFunction(const char *chave);
+int hashFunction(const char *chave, int capacidade);
 
 /**
  * inserirNaHash() - Insere associação pista/suspeito na tabela hash
@@ -164,12 +397,43 @@ int hashFunction(const char *chave);
  * Implementa tratamento de colisão por sondagem linear.
  * Armazena a associação pista -> suspeito para consulta posterior.
  * Usa hash com sondagem linear para resolver colisões.
+ * Dobra a capacidade antes que mais da metade das posições esteja ocupada.
  *
  * @param tabela: Ponteiro para a tabela hash
  * @param pista: Chave (pista encontrada)
  * @param suspeito: Valor (suspeito associado)
  */
-void inserirNaHash(EntradaHash *tabela, const char *pista, const char *suspeito);
+void inserirNaHash(TabelaHash *tabela, const char *pista, const char *suspeito);
+
+/**
+ * calcularHashesEmLote() - Calcula hashFunction() de várias chaves
+ *
+ * A partir de LIMIAR_HASH_PARALELO chaves, divide o trabalho entre até
+ * MAX_THREADS_HASH threads; abaixo disso calcula na thread atual.
+ *
+ * @param chaves: Vetor de chaves
+ * @param quantidade: Número de chaves
+ * @param capacidade: Capacidade da tabela de destino
+ * @param hashes: Saída, um índice por chave
+ */
+void calcularHashesEmLote(const char *const *chaves, int quantidade, int capacidade, int *hashes);
+
+/**
+ * inserirNaHashEmLote() - Preenche a tabela com várias associações em uma passada
+ *
+ * A tabela é redimensionada uma única vez para a menor potência de dois
+ * que comporte o dobro das associações, então os hashes são calculados
+ * com calcularHashesEmLote() e cada associação é posicionada por
+ * sondagem linear, sem crescimentos intermediários.
+ *
+ * @param tabela: Ponteiro para a tabela hash
+ * @param pistas: Chaves
+ * @param suspeitos: Valores, na mesma ordem das chaves
+ * @param quantidade: Número de associações
+ * @return: 1 se sucesso, 0 em falha de alocação
+ */
+int inserirNaHashEmLote(TabelaHash *tabela, const char *const *pistas,
+                        const char *const *suspeitos, int quantidade);
 
 /**
  * encontrarSuspeito() - Consulta o suspeito correspondente a uma pista
@@ -182,17 +446,62 @@ void inserirNaHash(EntradaHash *tabela, const char *pista, const char *suspeito)
  * @param pista: Chave (pista para buscar)
  * @return: String contendo o nome do suspeito ou "DESCONHECIDO"
  */
-const char *encontrarSuspeito(EntradaHash *tabela, const char *pista);
+const char *encontrarSuspeito(const TabelaHash *tabela, const char *pista);
+
+/**
+ * populaTabelaHash() - Define as associações pista -> suspeito do caso
+ *
+ * @return: 1 se sucesso, 0 em falha de alocação
+ */
+int populaTabelaHash(TabelaHash *tabela);
 
 /**
  * contarPistasPorSuspeito() - Conta quantas pistas apontam para um suspeito
  */
-int contarPistasPorSuspeito(EntradaHash *tabela, NoPista *pistas, const char *suspeito);
+int contarPistasPorSuspeito(const TabelaHash *tabela, NoPista *pistas, const char *suspeito);
 
 /**
  * liberarHash() - Libera memória da tabela hash
  */
-void liberarHash(EntradaHash *tabela);
+void liberarHash(TabelaHash *tabela);
+
+// ============ FUNÇÕES DE AGREGADOS DE EVIDÊNCIA ============
+
+/**
+ * anotarEvidencias() - Anota cada sala com contagens por suspeito da subárvore
+ *
+ * Chamada por carregarCaso(), depois de popular a tabela hash.
+ * Uma passada em pré-ordem preenche pai, id e suspeito de cada sala e
+ * registra os suspeitos encontrados; conhecido o total, uma passada
+ * pós-ordem preenche caso->pistasSubarvore, com uma linha de
+ * totalSuspeitos contagens por sala (índice id * totalSuspeitos + s).
+ *
+ * @param caso: Caso com mansão e tabela hash já populadas
+ * @return: 1 se sucesso, 0 em falha de alocação
+ */
+int anotarEvidencias(CasoDetective *caso);
+
+/**
+ * indiceSuspeito() - Retorna o índice de um suspeito conhecido ou -1
+ */
+int indiceSuspeito(const CasoDetective *caso, const char *suspeito);
+
+/**
+ * pistasRestantesNaSubarvore() - Pistas de um suspeito ainda não coletadas
+ * abaixo (e incluindo) uma sala. O(1) após anotarEvidencias().
+ */
+int pistasRestantesNaSubarvore(const JogoDetectiveQuest *jogo, const NoSala *sala, int suspeito);
+
+/**
+ * condenacaoPossivel() - Verifica se algum suspeito ainda pode chegar a
+ * MIN_PISTAS_ACUSACAO pistas
+ *
+ * Soma as pistas já coletadas de cada suspeito com as que restam na
+ * subárvore da sala. O(suspeitos) por consulta.
+ *
+ * @return: 1 se alguma condenação ainda é possível por este caminho, 0 caso contrário
+ */
+int condenacaoPossivel(const JogoDetectiveQuest *jogo, const NoSala *sala);
 
 // ============ FUNÇÕES DE JULGAMENTO FINAL ============
 
@@ -208,7 +517,7 @@ void liberarHash(EntradaHash *tabela);
  * @param tabela: Tabela hash para consultas
  * @return: 1 se acusação correta, 0 caso contrário
  */
-int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, EntradaHash *tabela);
+int verificarSuspeitoFinal(JogoDetectiveQuest *jogo, const TabelaHash *tabela);
 
 /**
  * exibirResultadoFinal() - Exibe o resultado da acusação
@@ -218,12 +527,15 @@ void exibirResultadoFinal(int acertou, const char *suspeito, int pistasSuspeito)
 // ============ FUNÇÕES AUXILIARES ============
 
 /**
- * inicializarJogo() - Inicializa todas as estruturas do jogo
+ * inicializarJogo() - Inicializa o estado de um jogador para um caso
+ *
+ * @param caso: Caso carregado (retido pelo jogo até liberarJogo())
+ * @return: Novo jogo ou NULL em erro
  */
-JogoDetectiveQuest *inicializarJogo(void);
+JogoDetectiveQuest *inicializarJogo(CasoDetective *caso);
 
 /**
- * liberarJogo() - Libera toda a memória alocada
+ * liberarJogo() - Libera o estado do jogador e solta o caso
  */
 void liberarJogo(JogoDetectiveQuest *jogo);
 
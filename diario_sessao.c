@@ -0,0 +1,335 @@
+/**
+ * DETECTIVE QUEST - Implementação do Diário de Sessão
+ * Buffer circular sem locks + thread escritora em segundo plano
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "diario_sessao.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define DIARIO_MASCARA (DIARIO_CAPACIDADE - 1)
+#define DIARIO_REGISTRO_FIXO 17   // tipo, argumento, sala, valor, instante, tamanho do texto
+#define DIARIO_ESPERA_MIN_NS 1000000ull  // Primeira pausa do escritor ocioso (1 ms)
+
+/**
+ * Diário aberto
+ * cabeca só é escrita pelo produtor e cauda só pelo escritor
+ */
+struct DiarioSessao {
+    EventoDiario eventos[DIARIO_CAPACIDADE];
+    _Atomic size_t cabeca;       // Próximo slot a ser preenchido
+    _Atomic size_t cauda;        // Próximo slot a ser gravado
+    _Atomic int ativo;           // 0 pede que o escritor esvazie e termine
+    int fd;                      // Descritor do arquivo
+    PoliticaFsync politica;
+    int intervaloFsyncMs;
+    uint64_t inicio;             // Relógio monotônico na abertura (ns)
+    pthread_t escritor;
+    pthread_mutex_t mutexEspera; // Só o escritor ocioso e fecharDiario() usam
+    pthread_cond_t sinalFechar;  // Acorda o escritor ocioso ao fechar
+};
+
+// ============ IMPLEMENTAÇÃO: UTILITÁRIOS ============
+
+/**
+ * agoraNs() - Relógio monotônico em nanossegundos
+ */
+static uint64_t agoraNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * escreverTudo() - write() repetido até gravar todos os bytes
+ */
+static int escreverTudo(int fd, const unsigned char *dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t escrito = write(fd, dados, tamanho);
+        if (escrito < 0) return 0;
+        dados += escrito;
+        tamanho -= (size_t)escrito;
+    }
+    return 1;
+}
+
+/**
+ * codificarEvento() - Serializa um evento em little-endian
+ * Retorna o número de bytes gravados em destino
+ */
+static size_t codificarEvento(const EventoDiario *evento, unsigned char *destino) {
+    size_t lenTexto = strnlen(evento->texto, DIARIO_TEXTO_LEN - 1);
+
+    destino[0] = evento->tipo;
+    destino[1] = evento->argumento;
+    for (int i = 0; i < 2; i++) destino[2 + i] = (unsigned char)(evento->sala >> (8 * i));
+    for (int i = 0; i < 4; i++) destino[4 + i] = (unsigned char)(evento->valor >> (8 * i));
+    for (int i = 0; i < 8; i++) destino[8 + i] = (unsigned char)(evento->instante >> (8 * i));
+    destino[16] = (unsigned char)lenTexto;
+    memcpy(destino + DIARIO_REGISTRO_FIXO, evento->texto, lenTexto);
+
+    return DIARIO_REGISTRO_FIXO + lenTexto;
+}
+
+// ============ IMPLEMENTAÇÃO: THREAD ESCRITORA ============
+
+/**
+ * esperarOcioso() - Dorme até esperaNs ou até fecharDiario() sinalizar
+ * O produtor não participa: eventos novos são vistos no próximo despertar
+ */
+static void esperarOcioso(DiarioSessao *diario, uint64_t esperaNs) {
+    struct timespec prazo;
+    clock_gettime(CLOCK_MONOTONIC, &prazo);
+    uint64_t ns = (uint64_t)prazo.tv_nsec + esperaNs;
+    prazo.tv_sec += (time_t)(ns / 1000000000ull);
+    prazo.tv_nsec = (long)(ns % 1000000000ull);
+
+    pthread_mutex_lock(&diario->mutexEspera);
+    if (atomic_load_explicit(&diario->ativo, memory_order_acquire)) {
+        pthread_cond_timedwait(&diario->sinalFechar, &diario->mutexEspera, &prazo);
+    }
+    pthread_mutex_unlock(&diario->mutexEspera);
+}
+
+/**
+ * executarEscritor() - Esvazia o buffer em lotes e aplica a política de fsync
+ * Ocioso, dobra a pausa de 1 ms até o intervalo de fsync; ao ser
+ * desativada, grava o restante e sai
+ */
+static void *executarEscritor(void *argumento) {
+    DiarioSessao *diario = (DiarioSessao *)argumento;
+    unsigned char lote[DIARIO_LOTE * (DIARIO_REGISTRO_FIXO + DIARIO_TEXTO_LEN)];
+    uint64_t ultimoFsync = agoraNs();
+    int pendente = 0;  // Há dados gravados ainda sem fsync
+    uint64_t esperaMaxNs = (uint64_t)diario->intervaloFsyncMs * 1000000ull;
+    uint64_t esperaNs = DIARIO_ESPERA_MIN_NS;
+
+    for (;;) {
+        int ativo = atomic_load_explicit(&diario->ativo, memory_order_acquire);
+        size_t cauda = atomic_load_explicit(&diario->cauda, memory_order_relaxed);
+        size_t cabeca = atomic_load_explicit(&diario->cabeca, memory_order_acquire);
+
+        if (cauda == cabeca) {
+            if (!ativo) break;
+
+            esperarOcioso(diario, esperaNs);
+            esperaNs = esperaNs * 2 < esperaMaxNs ? esperaNs * 2 : esperaMaxNs;
+        } else {
+            esperaNs = DIARIO_ESPERA_MIN_NS;
+
+            size_t tamanho = 0;
+            int quantidade = 0;
+            while (cauda != cabeca && quantidade < DIARIO_LOTE) {
+                tamanho += codificarEvento(&diario->eventos[cauda & DIARIO_MASCARA], lote + tamanho);
+                cauda++;
+                quantidade++;
+            }
+            // Slots já copiados podem ser reutilizados pelo produtor
+            atomic_store_explicit(&diario->cauda, cauda, memory_order_release);
+
+            if (!escreverTudo(diario->fd, lote, tamanho)) {
+                perror("Erro ao gravar diário");
+            }
+            pendente = 1;
+
+            if (diario->politica == DIARIO_FSYNC_LOTE) {
+                fsync(diario->fd);
+                pendente = 0;
+            }
+        }
+
+        if (pendente && diario->politica == DIARIO_FSYNC_INTERVALO &&
+            agoraNs() - ultimoFsync >= (uint64_t)diario->intervaloFsyncMs * 1000000ull) {
+            fsync(diario->fd);
+            ultimoFsync = agoraNs();
+            pendente = 0;
+        }
+    }
+
+    if (pendente && diario->politica != DIARIO_FSYNC_NUNCA) {
+        fsync(diario->fd);
+    }
+    return NULL;
+}
+
+// ============ IMPLEMENTAÇÃO: ESCRITA ============
+
+/**
+ * abrirDiario() - Abre o arquivo em modo de acréscimo e inicia o escritor
+ */
+DiarioSessao *abrirDiario(const char *caminho, PoliticaFsync politica, int intervaloFsyncMs) {
+    DiarioSessao *diario = (DiarioSessao *)malloc(sizeof(DiarioSessao));
+    if (diario == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para diário!\n");
+        return NULL;
+    }
+
+    diario->fd = open(caminho, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (diario->fd < 0) {
+        perror("Erro ao abrir diário");
+        free(diario);
+        return NULL;
+    }
+
+    // Arquivo existente só recebe eventos se já for um diário desta versão
+    if (lseek(diario->fd, 0, SEEK_END) > 0) {
+        unsigned char cabecalho[5];
+        if (pread(diario->fd, cabecalho, sizeof(cabecalho), 0) != (ssize_t)sizeof(cabecalho) ||
+            memcmp(cabecalho, DIARIO_MAGICO, 4) != 0 || cabecalho[4] != DIARIO_VERSAO) {
+            fprintf(stderr, "%s não é um diário Detective Quest versão %d; nada foi gravado!\n",
+                    caminho, DIARIO_VERSAO);
+            close(diario->fd);
+            free(diario);
+            return NULL;
+        }
+    } else {
+        // Arquivo novo: grava o cabeçalho
+        unsigned char cabecalho[5];
+        memcpy(cabecalho, DIARIO_MAGICO, 4);
+        cabecalho[4] = DIARIO_VERSAO;
+        if (!escreverTudo(diario->fd, cabecalho, sizeof(cabecalho))) {
+            perror("Erro ao gravar cabeçalho do diário");
+            close(diario->fd);
+            free(diario);
+            return NULL;
+        }
+    }
+
+    pthread_condattr_t atributos;
+    pthread_condattr_init(&atributos);
+    pthread_condattr_setclock(&atributos, CLOCK_MONOTONIC);
+    pthread_cond_init(&diario->sinalFechar, &atributos);
+    pthread_condattr_destroy(&atributos);
+    pthread_mutex_init(&diario->mutexEspera, NULL);
+
+    atomic_init(&diario->cabeca, 0);
+    atomic_init(&diario->cauda, 0);
+    atomic_init(&diario->ativo, 1);
+    diario->politica = politica;
+    diario->intervaloFsyncMs = intervaloFsyncMs > 0 ? intervaloFsyncMs : 1000;
+    diario->inicio = agoraNs();
+
+    if (pthread_create(&diario->escritor, NULL, executarEscritor, diario) != 0) {
+        fprintf(stderr, "Erro ao iniciar escritor do diário!\n");
+        pthread_cond_destroy(&diario->sinalFechar);
+        pthread_mutex_destroy(&diario->mutexEspera);
+        close(diario->fd);
+        free(diario);
+        return NULL;
+    }
+
+    return diario;
+}
+
+/**
+ * registrarEvento() - Produtor: preenche o slot da cabeça e publica
+ */
+void registrarEvento(DiarioSessao *diario, TipoEvento tipo, uint8_t argumento,
+                     uint16_t sala, uint32_t valor, const char *texto) {
+    if (diario == NULL) return;
+
+    size_t cabeca = atomic_load_explicit(&diario->cabeca, memory_order_relaxed);
+
+    // Buffer cheio: espera o escritor liberar um slot
+    while (cabeca - atomic_load_explicit(&diario->cauda, memory_order_acquire) >= DIARIO_CAPACIDADE) {
+        sched_yield();
+    }
+
+    EventoDiario *evento = &diario->eventos[cabeca & DIARIO_MASCARA];
+    evento->tipo = (uint8_t)tipo;
+    evento->argumento = argumento;
+    evento->sala = sala;
+    evento->valor = valor;
+    evento->instante = agoraNs() - diario->inicio;
+    if (texto != NULL) {
+        strncpy(evento->texto, texto, DIARIO_TEXTO_LEN - 1);
+        evento->texto[DIARIO_TEXTO_LEN - 1] = '\0';
+    } else {
+        evento->texto[0] = '\0';
+    }
+
+    atomic_store_explicit(&diario->cabeca, cabeca + 1, memory_order_release);
+}
+
+/**
+ * fecharDiario() - Sinaliza o escritor, aguarda o esvaziamento e fecha o arquivo
+ */
+void fecharDiario(DiarioSessao *diario) {
+    if (diario == NULL) return;
+
+    // Sob o mutex para não perder o sinal entre o teste de ativo e a espera
+    pthread_mutex_lock(&diario->mutexEspera);
+    atomic_store_explicit(&diario->ativo, 0, memory_order_release);
+    pthread_cond_signal(&diario->sinalFechar);
+    pthread_mutex_unlock(&diario->mutexEspera);
+
+    pthread_join(diario->escritor, NULL);
+    pthread_cond_destroy(&diario->sinalFechar);
+    pthread_mutex_destroy(&diario->mutexEspera);
+    close(diario->fd);
+    free(diario);
+}
+
+// ============ IMPLEMENTAÇÃO: LEITURA ============
+
+/**
+ * lerCabecalhoDiario() - Confere o número mágico e a versão
+ */
+int lerCabecalhoDiario(FILE *arquivo) {
+    unsigned char cabecalho[5];
+    if (fread(cabecalho, 1, sizeof(cabecalho), arquivo) != sizeof(cabecalho)) return 0;
+    return memcmp(cabecalho, DIARIO_MAGICO, 4) == 0 && cabecalho[4] >= 1 && cabecalho[4] <= DIARIO_VERSAO;
+}
+
+/**
+ * lerEventoDiario() - Inverso de codificarEvento()
+ * Só é fim normal se nenhum byte do próximo registro existir
+ */
+int lerEventoDiario(FILE *arquivo, EventoDiario *evento) {
+    unsigned char fixo[DIARIO_REGISTRO_FIXO];
+    size_t lidos = fread(fixo, 1, sizeof(fixo), arquivo);
+    if (lidos == 0 && feof(arquivo)) return 0;
+    if (lidos != sizeof(fixo)) return -1;
+
+    evento->tipo = fixo[0];
+    evento->argumento = fixo[1];
+    evento->sala = 0;
+    evento->valor = 0;
+    evento->instante = 0;
+    for (int i = 0; i < 2; i++) evento->sala |= (uint16_t)(fixo[2 + i] << (8 * i));
+    for (int i = 0; i < 4; i++) evento->valor |= (uint32_t)fixo[4 + i] << (8 * i);
+    for (int i = 0; i < 8; i++) evento->instante |= (uint64_t)fixo[8 + i] << (8 * i);
+
+    size_t lenTexto = fixo[16];
+    if (lenTexto >= DIARIO_TEXTO_LEN) return -1;
+    if (fread(evento->texto, 1, lenTexto, arquivo) != lenTexto) return -1;
+    evento->texto[lenTexto] = '\0';
+
+    return 1;
+}
+
+/**
+ * nomeTipoEvento() - Tabela de nomes para exibição
+ */
+const char *nomeTipoEvento(uint8_t tipo) {
+    switch (tipo) {
+        case EVENTO_INICIO:           return "INICIO";
+        case EVENTO_MOVIMENTO:        return "MOVIMENTO";
+        case EVENTO_PISTA:            return "PISTA";
+        case EVENTO_DESFAZER:         return "DESFAZER";
+        case EVENTO_ACUSACAO:         return "ACUSACAO";
+        case EVENTO_FIM:              return "FIM";
+        case EVENTO_RESTAURACAO:      return "RESTAURACAO";
+        case EVENTO_PISTA_RESTAURADA: return "RESTAURADA";
+        default:                      return "DESCONHECIDO";
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * DETECTIVE QUEST - Diário de Sessão (Header)
+ * Registro binário, somente de acréscimo, dos eventos de uma partida
+ */
+
+#ifndef DIARIO_SESSAO_H
+#define DIARIO_SESSAO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define DIARIO_MAGICO "DQJ1"
+#define DIARIO_VERSAO 2           // Versão 2: textos de pista restaurada (até PISTA_LEN)
+#define DIARIO_TEXTO_LEN 100      // Igual a PISTA_LEN
+#define DIARIO_CAPACIDADE 1024    // Slots do buffer circular (potência de 2)
+#define DIARIO_LOTE 64            // Máximo de eventos por escrita em disco
+
+// ============ ESTRUTURAS DE DADOS ============
+
+/**
+ * Tipos de evento registrados no diário
+ */
+typedef enum {
+    EVENTO_INICIO = 1,    // Início da exploração (sala = raiz, texto = nome do caso)
+    EVENTO_MOVIMENTO,     // Movimento para sala filha (argumento = 'e' ou 'd')
+    EVENTO_PISTA,         // Nova pista coletada na sala
+    EVENTO_DESFAZER,      // Movimento desfeito, volta para a sala pai
+    EVENTO_ACUSACAO,      // Acusação (texto = suspeito, valor = pistas, argumento = acertou)
+    EVENTO_FIM,           // Fim da sessão
+    EVENTO_RESTAURACAO,   // Pistas substituídas (valor = quantidade de EVENTO_PISTA_RESTAURADA a seguir)
+    EVENTO_PISTA_RESTAURADA  // Pista do conjunto restaurado, em ordem (texto = pista)
+} TipoEvento;
+
+/**
+ * Política de fsync do escritor em segundo plano
+ */
+typedef enum {
+    DIARIO_FSYNC_NUNCA,      // Deixa o sistema operacional decidir
+    DIARIO_FSYNC_LOTE,       // fsync após cada lote escrito
+    DIARIO_FSYNC_INTERVALO   // fsync no máximo a cada intervaloFsyncMs
+} PoliticaFsync;
+
+/**
+ * Evento do diário
+ * Em memória ocupa um slot fixo; em disco apenas o texto usado é gravado
+ */
+typedef struct {
+    uint8_t tipo;                    // TipoEvento
+    uint8_t argumento;               // Direção ou resultado, conforme o tipo
+    uint16_t sala;                   // id da sala (ver anotarEvidencias())
+    uint32_t valor;                  // Dado numérico do evento
+    uint64_t instante;               // Nanossegundos desde a abertura do diário
+    char texto[DIARIO_TEXTO_LEN];    // Texto opcional (string vazia se ausente)
+} EventoDiario;
+
+/**
+ * Diário aberto: buffer circular produtor único / consumidor único
+ * e thread escritora. Definição opaca em diario_sessao.c
+ */
+typedef struct DiarioSessao DiarioSessao;
+
+// ============ FUNÇÕES DE ESCRITA ============
+
+/**
+ * abrirDiario() - Cria o arquivo do diário e inicia a thread escritora
+ *
+ * O arquivo é aberto em modo de acréscimo; se estiver vazio, o
+ * cabeçalho (DIARIO_MAGICO + versão) é gravado primeiro. Um arquivo
+ * não vazio só é aceito se já começar com DIARIO_MAGICO e DIARIO_VERSAO.
+ *
+ * @param caminho: Caminho do arquivo do diário
+ * @param politica: Política de fsync do escritor
+ * @param intervaloFsyncMs: Intervalo para DIARIO_FSYNC_INTERVALO (ignorado nas demais)
+ * @return: Diário aberto ou NULL em caso de erro
+ */
+DiarioSessao *abrirDiario(const char *caminho, PoliticaFsync politica, int intervaloFsyncMs);
+
+/**
+ * registrarEvento() - Empurra um evento no buffer circular (sem locks)
+ *
+ * Deve ser chamado sempre pela mesma thread (produtor único). Não faz
+ * I/O; se o buffer estiver cheio, cede a CPU até o escritor liberar espaço.
+ * Aceita diario == NULL (diário desativado) e nesse caso não faz nada.
+ *
+ * @param diario: Diário aberto ou NULL
+ * @param tipo: Tipo do evento
+ * @param argumento: Direção ou resultado
+ * @param sala: id da sala
+ * @param valor: Dado numérico
+ * @param texto: Texto opcional (pode ser NULL)
+ */
+void registrarEvento(DiarioSessao *diario, TipoEvento tipo, uint8_t argumento,
+                     uint16_t sala, uint32_t valor, const char *texto);
+
+/**
+ * fecharDiario() - Esvazia o buffer, aplica fsync final e encerra a thread
+ */
+void fecharDiario(DiarioSessao *diario);
+
+// ============ FUNÇÕES DE LEITURA ============
+
+/**
+ * lerEventoDiario() - Decodifica o próximo evento de um arquivo do diário
+ *
+ * O cabeçalho deve ter sido validado antes com lerCabecalhoDiario().
+ *
+ * @param arquivo: Arquivo aberto em modo binário
+ * @param evento: Destino do evento decodificado
+ * @return: 1 se leu um evento, 0 no fim do arquivo (fronteira de registro),
+ *          -1 se o registro está truncado, corrompido ou houve erro de leitura
+ */
+int lerEventoDiario(FILE *arquivo, EventoDiario *evento);
+
+/**
+ * lerCabecalhoDiario() - Valida o cabeçalho do arquivo
+ *
+ * Diários da versão 1 continuam legíveis: seus textos cabem no slot atual
+ * e abrirDiario() nunca acrescenta eventos da versão atual a eles, então
+ * um arquivo nunca mistura versões.
+ *
+ * @return: 1 se o arquivo é um diário de versão suportada, 0 caso contrário
+ */
+int lerCabecalhoDiario(FILE *arquivo);
+
+/**
+ * nomeTipoEvento() - Nome legível de um tipo de evento
+ */
+const char *nomeTipoEvento(uint8_t tipo);
+
+#endif // DIARIO_SESSAO_H
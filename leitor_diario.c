@@ -0,0 +1,208 @@
+/**
+ * DETECTIVE QUEST - Leitor do Diário de Sessão
+ * Decodifica um diário binário e reexecuta a sessão no motor do jogo
+ */
+
+#include "detective_quest.h"
+#include "registro_casos.h"
+
+#define ORCAMENTO_CASOS (1024 * 1024)  // Mesmo orçamento do jogo
+
+/**
+ * Restauração em andamento: pistas acumuladas até chegarem todas as anunciadas
+ */
+typedef struct {
+    char *textos;         // esperadas * DIARIO_TEXTO_LEN bytes
+    const char **pistas;  // Ponteiros para textos, na ordem do diário
+    int esperadas;
+    int recebidas;
+} RestauracaoPendente;
+
+/**
+ * descartarRestauracao() - Libera as pistas acumuladas
+ */
+static void descartarRestauracao(RestauracaoPendente *restauracao) {
+    free(restauracao->textos);
+    free(restauracao->pistas);
+    restauracao->textos = NULL;
+    restauracao->pistas = NULL;
+    restauracao->esperadas = 0;
+    restauracao->recebidas = 0;
+}
+
+/**
+ * concluirRestauracao() - Aplica as pistas acumuladas e confere o total
+ */
+static int concluirRestauracao(JogoDetectiveQuest *jogo, RestauracaoPendente *restauracao) {
+    int esperadas = restauracao->esperadas;
+    int sucesso = restaurarPistas(jogo, restauracao->pistas, esperadas) &&
+                  jogo->totalPistas == esperadas;
+    descartarRestauracao(restauracao);
+    return sucesso;
+}
+
+/**
+ * exibirEvento() - Imprime um evento decodificado em uma linha
+ */
+static void exibirEvento(const EventoDiario *evento) {
+    printf("%12.3f ms  %-10s sala=%-3u", evento->instante / 1e6,
+           nomeTipoEvento(evento->tipo), (unsigned)evento->sala);
+
+    if (evento->tipo == EVENTO_INICIO) {
+        printf(" caso=%s", evento->texto);
+    } else if (evento->tipo == EVENTO_MOVIMENTO) {
+        printf(" direcao=%c", evento->argumento);
+    } else if (evento->tipo == EVENTO_ACUSACAO) {
+        printf(" suspeito=%s pistas=%u acertou=%u", evento->texto,
+               (unsigned)evento->valor, (unsigned)evento->argumento);
+    } else if (evento->tipo == EVENTO_FIM || evento->tipo == EVENTO_RESTAURACAO) {
+        printf(" pistas=%u", (unsigned)evento->valor);
+    } else if (evento->tipo == EVENTO_PISTA_RESTAURADA) {
+        printf(" pista=%s", evento->texto);
+    }
+    printf("\n");
+}
+
+/**
+ * reexecutarEvento() - Aplica um evento ao jogo e confere com o registrado
+ * Usa as mesmas funções do motor que a exploração interativa
+ *
+ * @return: 1 se o estado reconstruído confere com o evento, 0 se diverge
+ */
+static int reexecutarEvento(JogoDetectiveQuest *jogo, NoSala **atual,
+                            RestauracaoPendente *restauracao, const EventoDiario *evento) {
+    // Uma restauração incompleta não pode ser interrompida por outro evento
+    if (restauracao->recebidas < restauracao->esperadas && evento->tipo != EVENTO_PISTA_RESTAURADA) {
+        descartarRestauracao(restauracao);
+        return 0;
+    }
+    
+    switch (evento->tipo) {
+        case EVENTO_INICIO:
+            *atual = jogo->caso->raizMansao;
+            return (*atual)->id == evento->sala;
+        case EVENTO_MOVIMENTO: {
+            NoSala *destino = evento->argumento == 'e' ? (*atual)->esquerda : (*atual)->direita;
+            if (destino == NULL || destino->id != evento->sala) return 0;
+            if (!salvarVersaoPistas(jogo)) return 0;
+            *atual = destino;
+            return 1;
+        }
+        case EVENTO_PISTA:
+            return (*atual)->id == evento->sala && coletarPista(jogo, *atual);
+        case EVENTO_DESFAZER:
+            if ((*atual)->id != evento->sala || (*atual)->pai == NULL) return 0;
+            if (!desfazerVersaoPistas(jogo)) return 0;
+            *atual = (*atual)->pai;
+            return 1;
+        case EVENTO_ACUSACAO: {
+            int pistas = contarPistasPorSuspeito(jogo->caso->tabelaHash, jogo->raizPistas, evento->texto);
+            return (uint32_t)pistas == evento->valor &&
+                   (pistas >= MIN_PISTAS_ACUSACAO) == evento->argumento;
+        }
+        case EVENTO_FIM:
+            return (uint32_t)jogo->totalPistas == evento->valor;
+        case EVENTO_RESTAURACAO: {
+            if (evento->valor > (uint32_t)(INT32_MAX / DIARIO_TEXTO_LEN)) return 0;
+            int esperadas = (int)evento->valor;
+            if (esperadas > 0) {
+                restauracao->textos = (char *)malloc((size_t)esperadas * DIARIO_TEXTO_LEN);
+                restauracao->pistas = (const char **)malloc(sizeof(const char *) * (size_t)esperadas);
+                if (restauracao->textos == NULL || restauracao->pistas == NULL) {
+                    descartarRestauracao(restauracao);
+                    return 0;
+                }
+            }
+            restauracao->esperadas = esperadas;
+            // Conjunto vazio: nenhuma EVENTO_PISTA_RESTAURADA a esperar
+            return esperadas > 0 || concluirRestauracao(jogo, restauracao);
+        }
+        case EVENTO_PISTA_RESTAURADA: {
+            if (restauracao->recebidas >= restauracao->esperadas) return 0;
+            char *texto = restauracao->textos + (size_t)restauracao->recebidas * DIARIO_TEXTO_LEN;
+            memcpy(texto, evento->texto, DIARIO_TEXTO_LEN);
+            restauracao->pistas[restauracao->recebidas++] = texto;
+            return restauracao->recebidas < restauracao->esperadas ||
+                   concluirRestauracao(jogo, restauracao);
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * main() - Uso: leitor_diario arquivo_diario
+ */
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Uso: %s arquivo_diario\n", argv[0]);
+        return 1;
+    }
+
+    FILE *arquivo = fopen(argv[1], "rb");
+    if (arquivo == NULL) {
+        perror("Erro ao abrir diário");
+        return 1;
+    }
+    if (!lerCabecalhoDiario(arquivo)) {
+        fprintf(stderr, "Arquivo não é um diário Detective Quest válido!\n");
+        fclose(arquivo);
+        return 1;
+    }
+
+    // Cada sessão obtém o próprio caso; sessões do mesmo caso o compartilham
+    RegistroCasos *registro = criarRegistroCasos(ORCAMENTO_CASOS);
+    if (registro == NULL || !registrarCasosEmbutidos(registro)) {
+        liberarRegistroCasos(registro);
+        fclose(arquivo);
+        return 1;
+    }
+
+    JogoDetectiveQuest *jogo = NULL;
+    NoSala *atual = NULL;
+    RestauracaoPendente restauracao = { NULL, NULL, 0, 0 };
+    EventoDiario evento;
+    int eventos = 0, divergencias = 0, lido;
+
+    while ((lido = lerEventoDiario(arquivo, &evento)) > 0) {
+        // Cada INICIO abre uma nova sessão (o arquivo é só de acréscimo)
+        if (evento.tipo == EVENTO_INICIO) {
+            if (restauracao.recebidas < restauracao.esperadas) {
+                printf("  ^ restauração incompleta antes da nova sessão\n");
+                divergencias++;
+            }
+            descartarRestauracao(&restauracao);
+            liberarJogo(jogo);
+            
+            // Diários sem nome de caso são anteriores ao registro de casos
+            CasoDetective *caso = obterCaso(registro, evento.texto[0] != '\0' ? evento.texto : CASO_PADRAO);
+            jogo = inicializarJogo(caso);
+            soltarCaso(caso);
+            printf("---- sessão ----\n");
+        }
+
+        exibirEvento(&evento);
+        eventos++;
+
+        if (jogo == NULL || !reexecutarEvento(jogo, &atual, &restauracao, &evento)) {
+            printf("  ^ DIVERGENTE na reexecução\n");
+            divergencias++;
+        }
+    }
+
+    if (lido < 0) {
+        printf("  ^ registro %d truncado ou corrompido\n", eventos + 1);
+        divergencias++;
+    }
+    if (restauracao.recebidas < restauracao.esperadas) {
+        printf("  ^ restauração incompleta no fim do diário\n");
+        divergencias++;
+    }
+    descartarRestauracao(&restauracao);
+    printf("\n%d eventos lidos, %d divergências\n", eventos, divergencias);
+
+    liberarJogo(jogo);
+    liberarRegistroCasos(registro);
+    fclose(arquivo);
+    return divergencias > 0;
+}
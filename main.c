@@ -4,46 +4,73 @@
  */
 
 #include "detective_quest.h"
+#include "registro_casos.h"
+#include "rastreamento.h"
+
+#define ORCAMENTO_CASOS (1024 * 1024)  // 1 MiB para casos residentes
 
 /**
- * populaTabelaHash() - Define as associações pista -> suspeito
- * Esta função pré-popula a tabela hash com as relações do jogo
+ * politicaFsyncPorNome() - Converte "nunca", "lote" ou "intervalo" na política
+ *
+ * @return: 1 se o nome é conhecido, 0 caso contrário
  */
-void populaTabelaHash(EntradaHash *tabela) {
-    // Pistas apontando para Mordecai
-    inserirNaHash(tabela, "Porta principal arrombada - sinal de invasão", "Mordecai");
-    inserirNaHash(tabela, "Cofre aberto e documentos espalhados", "Mordecai");
-    inserirNaHash(tabela, "Contrato rasgado com nome de um suspeito", "Mordecai");
-    
-    // Pistas apontando para Isabela
-    inserirNaHash(tabela, "Faca sangrenta na pia da cozinha", "Isabela");
-    inserirNaHash(tabela, "Pegadas de bota na lama próximo à janela", "Isabela");
-    
-    // Pistas apontando para Victor
-    inserirNaHash(tabela, "Taça de vinho vazia na mesa de centro", "Victor");
-    inserirNaHash(tabela, "Joia valiosa encontrada embaixo da cama", "Victor");
-    
-    // Pistas apontando para Camila
-    inserirNaHash(tabela, "Livro de contabilidade com anotações suspeitas", "Camila");
-    inserirNaHash(tabela, "Carta não enviada confessando um crime", "Camila");
+static int politicaFsyncPorNome(const char *nome, PoliticaFsync *politica) {
+    if (strcmp(nome, "nunca") == 0) *politica = DIARIO_FSYNC_NUNCA;
+    else if (strcmp(nome, "lote") == 0) *politica = DIARIO_FSYNC_LOTE;
+    else if (strcmp(nome, "intervalo") == 0) *politica = DIARIO_FSYNC_INTERVALO;
+    else return 0;
+    return 1;
 }
 
 /**
  * main() - Função principal: coordena todo o fluxo do jogo
+ *
+ * Uso: detective_quest [arquivo_diario [nunca|lote|intervalo]]
+ * Com arquivo_diario, os eventos da sessão são gravados em segundo plano.
+ * Com a variável DQ_RASTRO=arquivo.json, a latência de cada fase do turno
+ * é medida, os percentis são exibidos ao final e o trace é exportado.
  */
-int main(void) {
+int main(int argc, char *argv[]) {
     // Limpar buffer
     setbuf(stdout, NULL);
     
-    // Inicializar jogo
-    JogoDetectiveQuest *jogo = inicializarJogo();
+    // Validar argumentos antes de carregar qualquer coisa (fsync a cada segundo por padrão)
+    PoliticaFsync politica = DIARIO_FSYNC_INTERVALO;
+    if (argc > 2 && !politicaFsyncPorNome(argv[2], &politica)) {
+        fprintf(stderr, "Uso: %s [arquivo_diario [nunca|lote|intervalo]]\n", argv[0]);
+        return 1;
+    }
+    
+    // Rastreamento de latência opcional
+    const char *arquivoRastro = getenv("DQ_RASTRO");
+    if (arquivoRastro != NULL) {
+        iniciarRastreamento();
+    }
+    
+    // Registro de casos: carregados sob demanda, despejados por LRU
+    RegistroCasos *registro = criarRegistroCasos(ORCAMENTO_CASOS);
+    if (registro == NULL) return 1;
+    registrarCasosEmbutidos(registro);
+    
+    // Inicializar jogo: o caso é compartilhado, o estado é do jogador
+    CasoDetective *caso = obterCaso(registro, CASO_PADRAO);
+    JogoDetectiveQuest *jogo = inicializarJogo(caso);
+    soltarCaso(caso);
     if (jogo == NULL) {
         fprintf(stderr, "Erro ao inicializar jogo!\n");
+        liberarRegistroCasos(registro);
         return 1;
     }
     
-    // Popular tabela hash com associações pista -> suspeito
-    populaTabelaHash(jogo->tabelaHash);
+    // Diário de sessão opcional
+    if (argc > 1) {
+        jogo->diario = abrirDiario(argv[1], politica, 1000);
+        if (jogo->diario == NULL) {
+            liberarJogo(jogo);
+            liberarRegistroCasos(registro);
+            return 1;
+        }
+    }
     
     // Exibir menu e instruções
     exibirMenu();
@@ -55,13 +82,22 @@ int main(void) {
     printf("\n--- INICIANDO EXPLORAÇÃO ---\n");
     printf("Você entra na mansão escura...\n");
     
-    explorarSalas(jogo->raizMansao, jogo);
+    registrarEvento(jogo->diario, EVENTO_INICIO, 0, (uint16_t)jogo->caso->raizMansao->id, 0, jogo->caso->nome);
+    explorarSalas(jogo->caso->raizMansao, jogo);
     
     // Fase final: acusação
-    verificarSuspeitoFinal(jogo, jogo->tabelaHash);
+    verificarSuspeitoFinal(jogo, jogo->caso->tabelaHash);
+    registrarEvento(jogo->diario, EVENTO_FIM, 0, 0, (uint32_t)jogo->totalPistas, NULL);
     
     // Liberar memória
     liberarJogo(jogo);
+    liberarRegistroCasos(registro);
+    
+    if (rastreamentoAtivo()) {
+        exibirHistogramas(stderr);
+        exportarTraceChrome(arquivoRastro);
+        encerrarRastreamento();
+    }
     
     printf("\nObrigado por jogar Detective Quest!\n");
     
@@ -0,0 +1,327 @@
+/**
+ * DETECTIVE QUEST - Implementação do Rastreamento de Latência
+ * Buffers por thread, histogramas log-lineares e exportação Chrome trace
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "rastreamento.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RASTRO_TSC 1
+#endif
+
+/**
+ * Evento guardado para o trace (instantes em ticks do relógio)
+ */
+typedef struct {
+    uint64_t inicio;
+    uint64_t fim;
+    uint64_t descontado;  // Ticks fora da fase dentro de [inicio, fim]
+    uint8_t fase;
+} EventoRastro;
+
+/**
+ * Buffer de uma thread: só a própria thread escreve nele
+ * Os buffers formam uma lista global, percorrida na exportação
+ */
+typedef struct BufferRastro {
+    struct BufferRastro *proximo;
+    int idThread;
+    size_t totalEventos;
+    size_t descartados;
+    uint32_t histograma[TOTAL_FASES][RASTRO_BUCKETS];
+    uint64_t maximoNs[TOTAL_FASES];
+    EventoRastro eventos[RASTRO_EVENTOS_POR_THREAD];
+} BufferRastro;
+
+static const char *nomesFases[TOTAL_FASES] = {
+    "turno", "leitura_entrada", "busca_sala", "busca_pista",
+    "insercao_pista", "renderizacao", "acusacao", "registro"
+};
+
+static int ativo = 0;
+static double nsPorTick = 1.0;
+static uint64_t tickInicial = 0;
+static BufferRastro *buffers = NULL;
+static int totalThreads = 0;
+static pthread_mutex_t mutexBuffers = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local BufferRastro *bufferLocal = NULL;
+
+// ============ IMPLEMENTAÇÃO: RELÓGIO ============
+
+/**
+ * relogioMonotonicoNs() - CLOCK_MONOTONIC em nanossegundos
+ */
+static uint64_t relogioMonotonicoNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * lerTicks() - TSC quando disponível, senão o relógio monotônico
+ */
+static inline uint64_t lerTicks(void) {
+#ifdef RASTRO_TSC
+    return __rdtsc();
+#else
+    return relogioMonotonicoNs();
+#endif
+}
+
+/**
+ * calibrarTicks() - Mede quantos nanossegundos vale um tick do TSC
+ */
+static void calibrarTicks(void) {
+#ifdef RASTRO_TSC
+    uint64_t ns0 = relogioMonotonicoNs();
+    uint64_t tick0 = __rdtsc();
+
+    struct timespec pausa = { 0, 10000000 };
+    nanosleep(&pausa, NULL);
+
+    uint64_t ns1 = relogioMonotonicoNs();
+    uint64_t tick1 = __rdtsc();
+    nsPorTick = tick1 > tick0 ? (double)(ns1 - ns0) / (double)(tick1 - tick0) : 1.0;
+#else
+    nsPorTick = 1.0;
+#endif
+}
+
+// ============ IMPLEMENTAÇÃO: HISTOGRAMA ============
+
+/**
+ * bucketDe() - Índice log-linear: 8 sub-buckets por potência de 2 (erro < 12,5%)
+ */
+static int bucketDe(uint64_t valorNs) {
+    if (valorNs < 16) return (int)valorNs;
+
+    int expoente = 63 - __builtin_clzll(valorNs);
+    int sub = (int)((valorNs >> (expoente - 3)) & 7);
+    int indice = 16 + (expoente - 4) * 8 + sub;
+    return indice < RASTRO_BUCKETS ? indice : RASTRO_BUCKETS - 1;
+}
+
+/**
+ * valorDoBucket() - Ponto médio do intervalo coberto pelo bucket
+ */
+static uint64_t valorDoBucket(int indice) {
+    if (indice < 16) return (uint64_t)indice;
+
+    int expoente = (indice - 16) / 8 + 4;
+    int sub = (indice - 16) % 8;
+    uint64_t largura = 1ull << (expoente - 3);
+    return (uint64_t)(8 + sub) * largura + largura / 2;
+}
+
+/**
+ * percentil() - Valor do bucket que contém a fração pedida das amostras
+ */
+static uint64_t percentil(const uint32_t *histograma, uint64_t total, double fracao) {
+    uint64_t alvo = (uint64_t)(fracao * (double)total);
+    if (alvo >= total) alvo = total - 1;
+
+    uint64_t acumulado = 0;
+    for (int i = 0; i < RASTRO_BUCKETS; i++) {
+        acumulado += histograma[i];
+        if (acumulado > alvo) return valorDoBucket(i);
+    }
+    return valorDoBucket(RASTRO_BUCKETS - 1);
+}
+
+// ============ IMPLEMENTAÇÃO: REGISTRO ============
+
+/**
+ * obterBufferLocal() - Cria o buffer da thread no primeiro uso
+ * Só o registro na lista global usa mutex
+ */
+static BufferRastro *obterBufferLocal(void) {
+    if (bufferLocal != NULL) return bufferLocal;
+
+    BufferRastro *buffer = (BufferRastro *)calloc(1, sizeof(BufferRastro));
+    if (buffer == NULL) return NULL;
+
+    pthread_mutex_lock(&mutexBuffers);
+    buffer->idThread = ++totalThreads;
+    buffer->proximo = buffers;
+    buffers = buffer;
+    pthread_mutex_unlock(&mutexBuffers);
+
+    bufferLocal = buffer;
+    return buffer;
+}
+
+/**
+ * iniciarRastreamento() - Calibra o relógio e liga as medições
+ */
+int iniciarRastreamento(void) {
+    calibrarTicks();
+    tickInicial = lerTicks();
+    ativo = 1;
+    return obterBufferLocal() != NULL;
+}
+
+/**
+ * rastreamentoAtivo() - Estado atual do rastreamento
+ */
+int rastreamentoAtivo(void) {
+    return ativo;
+}
+
+/**
+ * inicioFase() - Lê o relógio apenas se ativo
+ */
+uint64_t inicioFase(void) {
+    return ativo ? lerTicks() : 0;
+}
+
+/**
+ * registrarFase() - Atualiza histograma e guarda o evento na thread atual
+ */
+static void registrarFase(FaseTurno fase, uint64_t inicio, uint64_t fim, uint64_t descontado) {
+    BufferRastro *buffer = obterBufferLocal();
+    if (buffer == NULL) return;
+
+    if (descontado > fim - inicio) descontado = fim - inicio;
+    uint64_t duracaoNs = (uint64_t)((double)(fim - inicio - descontado) * nsPorTick);
+    buffer->histograma[fase][bucketDe(duracaoNs)]++;
+    if (duracaoNs > buffer->maximoNs[fase]) buffer->maximoNs[fase] = duracaoNs;
+
+    if (buffer->totalEventos < RASTRO_EVENTOS_POR_THREAD) {
+        EventoRastro *evento = &buffer->eventos[buffer->totalEventos++];
+        evento->inicio = inicio;
+        evento->fim = fim;
+        evento->descontado = descontado;
+        evento->fase = (uint8_t)fase;
+    } else {
+        buffer->descartados++;
+    }
+}
+
+/**
+ * fimFase() - Registra sem desconto e devolve a duração
+ */
+uint64_t fimFase(FaseTurno fase, uint64_t inicio) {
+    if (!ativo || inicio == 0) return 0;
+
+    uint64_t fim = lerTicks();
+    registrarFase(fase, inicio, fim, 0);
+    return fim - inicio;
+}
+
+/**
+ * fimFaseDescontando() - Registra excluindo descontado da duração
+ */
+void fimFaseDescontando(FaseTurno fase, uint64_t inicio, uint64_t descontado) {
+    if (!ativo || inicio == 0) return;
+
+    registrarFase(fase, inicio, lerTicks(), descontado);
+}
+
+// ============ IMPLEMENTAÇÃO: EXPORTAÇÃO ============
+
+/**
+ * exibirHistogramas() - Junta os histogramas das threads e imprime percentis
+ */
+void exibirHistogramas(FILE *saida) {
+    static uint32_t combinado[RASTRO_BUCKETS];
+
+    pthread_mutex_lock(&mutexBuffers);
+
+    fprintf(saida, "\n%-16s %10s %10s %10s %10s %10s\n",
+            "fase", "amostras", "p50(us)", "p99(us)", "p999(us)", "max(us)");
+
+    for (int f = 0; f < TOTAL_FASES; f++) {
+        memset(combinado, 0, sizeof(combinado));
+        uint64_t total = 0, maximo = 0;
+
+        for (BufferRastro *b = buffers; b != NULL; b = b->proximo) {
+            for (int i = 0; i < RASTRO_BUCKETS; i++) {
+                combinado[i] += b->histograma[f][i];
+                total += b->histograma[f][i];
+            }
+            if (b->maximoNs[f] > maximo) maximo = b->maximoNs[f];
+        }
+        if (total == 0) continue;
+
+        // O ponto médio do bucket pode passar do máximo observado
+        uint64_t p50 = percentil(combinado, total, 0.50);
+        uint64_t p99 = percentil(combinado, total, 0.99);
+        uint64_t p999 = percentil(combinado, total, 0.999);
+        if (p50 > maximo) p50 = maximo;
+        if (p99 > maximo) p99 = maximo;
+        if (p999 > maximo) p999 = maximo;
+
+        fprintf(saida, "%-16s %10llu %10.2f %10.2f %10.2f %10.2f\n", nomesFases[f],
+                (unsigned long long)total, p50 / 1e3, p99 / 1e3, p999 / 1e3, maximo / 1e3);
+    }
+
+    pthread_mutex_unlock(&mutexBuffers);
+}
+
+/**
+ * exportarTraceChrome() - Eventos completos ("ph":"X") com ts/dur em µs
+ */
+int exportarTraceChrome(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "w");
+    if (arquivo == NULL) {
+        perror("Erro ao criar arquivo de trace");
+        return 0;
+    }
+
+    pthread_mutex_lock(&mutexBuffers);
+
+    fprintf(arquivo, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int primeiro = 1;
+    for (BufferRastro *b = buffers; b != NULL; b = b->proximo) {
+        for (size_t i = 0; i < b->totalEventos; i++) {
+            const EventoRastro *e = &b->eventos[i];
+            double ts = (double)(e->inicio - tickInicial) * nsPorTick / 1e3;
+            double dur = (double)(e->fim - e->inicio) * nsPorTick / 1e3;
+            fprintf(arquivo, "%s{\"name\":\"%s\",\"cat\":\"turno\",\"ph\":\"X\","
+                    "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d",
+                    primeiro ? "" : ",\n", nomesFases[e->fase], ts, dur, b->idThread);
+            if (e->descontado > 0) {
+                fprintf(arquivo, ",\"args\":{\"descontado_us\":%.3f}",
+                        (double)e->descontado * nsPorTick / 1e3);
+            }
+            fputc('}', arquivo);
+            primeiro = 0;
+        }
+        if (b->descartados > 0) {
+            fprintf(stderr, "Rastreamento: thread %d descartou %zu eventos do trace\n",
+                    b->idThread, b->descartados);
+        }
+    }
+    fprintf(arquivo, "\n]}\n");
+
+    pthread_mutex_unlock(&mutexBuffers);
+
+    return fclose(arquivo) == 0;
+}
+
+/**
+ * encerrarRastreamento() - Libera todos os buffers registrados
+ * Deve ser chamada quando nenhuma outra thread estiver medindo
+ */
+void encerrarRastreamento(void) {
+    ativo = 0;
+
+    pthread_mutex_lock(&mutexBuffers);
+    while (buffers != NULL) {
+        BufferRastro *proximo = buffers->proximo;
+        free(buffers);
+        buffers = proximo;
+    }
+    totalThreads = 0;
+    pthread_mutex_unlock(&mutexBuffers);
+
+    bufferLocal = NULL;
+}
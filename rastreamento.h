@@ -0,0 +1,102 @@
+/**
+ * DETECTIVE QUEST - Rastreamento de Latência (Header)
+ * Mede as fases de cada turno com relógio TSC, mantém histogramas por fase
+ * e exporta eventos no formato Chrome trace (chrome://tracing, Perfetto)
+ */
+
+#ifndef RASTREAMENTO_H
+#define RASTREAMENTO_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define RASTRO_EVENTOS_POR_THREAD 65536  // Eventos guardados por thread para o trace
+#define RASTRO_BUCKETS 512               // Buckets log-lineares do histograma
+
+// ============ ESTRUTURAS DE DADOS ============
+
+/**
+ * Fases medidas em um turno
+ */
+typedef enum {
+    FASE_TURNO,             // Trabalho do motor no turno, sem a espera pela entrada
+    FASE_LEITURA_ENTRADA,   // Espera e leitura da escolha do jogador
+    FASE_BUSCA_SALA,        // Resolução da sala de destino
+    FASE_BUSCA_PISTA,       // buscarPista()
+    FASE_INSERCAO_PISTA,    // inserirPistaPersistente() e agregados
+    FASE_RENDERIZACAO,      // exibirSala()
+    FASE_ACUSACAO,          // contarPistasPorSuspeito() na acusação
+    FASE_REGISTRO,          // Snapshot ou desfazer da versão e envio do evento ao diário
+    TOTAL_FASES
+} FaseTurno;
+
+// ============ FUNÇÕES DE RASTREAMENTO ============
+
+/**
+ * iniciarRastreamento() - Ativa o rastreamento e calibra o TSC
+ *
+ * Enquanto não for chamada, inicioFase()/fimFase() custam apenas um teste.
+ * A calibração compara o TSC com CLOCK_MONOTONIC por ~10 ms; em
+ * arquiteturas sem TSC o próprio relógio monotônico é usado.
+ *
+ * @return: 1 se ativado, 0 em erro
+ */
+int iniciarRastreamento(void);
+
+/**
+ * rastreamentoAtivo() - 1 se iniciarRastreamento() foi chamada
+ */
+int rastreamentoAtivo(void);
+
+/**
+ * inicioFase() - Marca o início de uma fase
+ *
+ * @return: Leitura do relógio (0 se o rastreamento está desativado)
+ */
+uint64_t inicioFase(void);
+
+/**
+ * fimFase() - Registra a duração da fase no buffer da thread atual
+ *
+ * Atualiza o histograma da fase e guarda o evento para o trace. Cada
+ * thread escreve apenas no próprio buffer, sem locks; se o buffer de
+ * eventos encher, o histograma continua sendo atualizado.
+ *
+ * @param fase: Fase medida
+ * @param inicio: Valor retornado por inicioFase()
+ * @return: Duração em ticks (0 se o rastreamento está desativado)
+ */
+uint64_t fimFase(FaseTurno fase, uint64_t inicio);
+
+/**
+ * fimFaseDescontando() - Como fimFase(), sem contar um intervalo interno
+ *
+ * Usada no turno para excluir a espera pela entrada do jogador. O
+ * histograma recebe a duração descontada; no trace o evento mantém o
+ * intervalo real e informa o desconto em "args".
+ *
+ * @param fase: Fase medida
+ * @param inicio: Valor retornado por inicioFase()
+ * @param descontado: Ticks a excluir (retorno de fimFase() da fase interna)
+ */
+void fimFaseDescontando(FaseTurno fase, uint64_t inicio, uint64_t descontado);
+
+/**
+ * exibirHistogramas() - Imprime contagem, p50, p99, p999 e máximo por fase (em µs)
+ */
+void exibirHistogramas(FILE *saida);
+
+/**
+ * exportarTraceChrome() - Grava os eventos de todas as threads em JSON
+ *
+ * @param caminho: Arquivo de saída (formato Trace Event, eventos "X")
+ * @return: 1 se sucesso, 0 em erro
+ */
+int exportarTraceChrome(const char *caminho);
+
+/**
+ * encerrarRastreamento() - Desativa o rastreamento e libera os buffers
+ */
+void encerrarRastreamento(void);
+
+#endif // RASTREAMENTO_H
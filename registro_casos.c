@@ -0,0 +1,173 @@
+/**
+ * DETECTIVE QUEST - Implementação do Registro de Casos
+ * Lista LRU de casos residentes com orçamento de memória
+ */
+
+#include "registro_casos.h"
+
+// ============ IMPLEMENTAÇÃO: LISTA LRU ============
+
+/**
+ * desvincularCaso() - Remove o caso da lista LRU
+ */
+static void desvincularCaso(RegistroCasos *registro, CasoDetective *caso) {
+    if (caso->anterior != NULL) caso->anterior->proximo = caso->proximo;
+    else registro->maisRecente = caso->proximo;
+
+    if (caso->proximo != NULL) caso->proximo->anterior = caso->anterior;
+    else registro->menosRecente = caso->anterior;
+
+    caso->anterior = NULL;
+    caso->proximo = NULL;
+}
+
+/**
+ * vincularNoInicio() - Insere o caso como o mais recente
+ */
+static void vincularNoInicio(RegistroCasos *registro, CasoDetective *caso) {
+    caso->anterior = NULL;
+    caso->proximo = registro->maisRecente;
+    if (registro->maisRecente != NULL) registro->maisRecente->anterior = caso;
+    else registro->menosRecente = caso;
+    registro->maisRecente = caso;
+}
+
+/**
+ * buscarFonte() - Busca linear pelo nome (poucos casos por processo)
+ */
+static FonteCaso *buscarFonte(RegistroCasos *registro, const char *nome) {
+    for (int i = 0; i < registro->totalFontes; i++) {
+        if (strcmp(registro->fontes[i].nome, nome) == 0) return &registro->fontes[i];
+    }
+    return NULL;
+}
+
+/**
+ * despejarCaso() - Remove um caso ocioso do registro e o libera
+ */
+static void despejarCaso(RegistroCasos *registro, CasoDetective *caso) {
+    FonteCaso *fonte = buscarFonte(registro, caso->nome);
+    if (fonte != NULL) fonte->residente = NULL;
+
+    desvincularCaso(registro, caso);
+    registro->memoriaCasos -= caso->memoria;
+    registro->despejos++;
+    liberarCaso(caso);
+}
+
+// ============ IMPLEMENTAÇÃO: REGISTRO ============
+
+/**
+ * criarRegistroCasos() - Registro sem fontes e sem casos residentes
+ */
+RegistroCasos *criarRegistroCasos(size_t orcamento) {
+    RegistroCasos *registro = (RegistroCasos *)calloc(1, sizeof(RegistroCasos));
+    if (registro == NULL) {
+        fprintf(stderr, "Erro ao alocar memória para registro de casos!\n");
+        return NULL;
+    }
+
+    registro->orcamento = orcamento;
+    return registro;
+}
+
+/**
+ * registrarFonteCaso() - Adiciona uma fonte sem carregar o caso
+ */
+int registrarFonteCaso(RegistroCasos *registro, const char *nome, CarregadorCaso carregar) {
+    if (registro == NULL || registro->totalFontes >= MAX_FONTES_CASOS) return 0;
+    if (buscarFonte(registro, nome) != NULL) return 0;
+
+    FonteCaso *fonte = &registro->fontes[registro->totalFontes++];
+    strncpy(fonte->nome, nome, SALA_LEN - 1);
+    fonte->nome[SALA_LEN - 1] = '\0';
+    fonte->carregar = carregar;
+    fonte->residente = NULL;
+    return 1;
+}
+
+/**
+ * registrarCasosEmbutidos() - Hoje apenas a mansão do jogo original
+ */
+int registrarCasosEmbutidos(RegistroCasos *registro) {
+    return registrarFonteCaso(registro, CASO_PADRAO, carregarCasoMansao);
+}
+
+/**
+ * obterCaso() - Acerto move o caso para a frente; falta carrega e aplica o orçamento
+ */
+CasoDetective *obterCaso(RegistroCasos *registro, const char *nome) {
+    if (registro == NULL || nome == NULL) return NULL;
+
+    FonteCaso *fonte = buscarFonte(registro, nome);
+    if (fonte == NULL) {
+        fprintf(stderr, "Caso desconhecido: %s\n", nome);
+        return NULL;
+    }
+
+    CasoDetective *caso = fonte->residente;
+    if (caso != NULL) {
+        desvincularCaso(registro, caso);
+        caso->referencias++;
+    } else {
+        caso = carregarCaso(fonte->nome, fonte->carregar);
+        if (caso == NULL) return NULL;
+
+        caso->registro = registro;
+        fonte->residente = caso;
+        registro->memoriaCasos += caso->memoria;
+        registro->carregamentos++;
+    }
+
+    vincularNoInicio(registro, caso);
+
+    // O caso obtido está retido e não pode ser despejado aqui
+    aplicarOrcamentoRegistro(registro);
+    return caso;
+}
+
+/**
+ * aplicarOrcamentoRegistro() - Percorre da cauda (menos recente) despejando ociosos
+ */
+void aplicarOrcamentoRegistro(RegistroCasos *registro) {
+    if (registro == NULL) return;
+
+    CasoDetective *atual = registro->menosRecente;
+    while (atual != NULL && memoriaRegistro(registro) > registro->orcamento) {
+        CasoDetective *anterior = atual->anterior;
+        if (atual->referencias == 0) {
+            despejarCaso(registro, atual);
+        }
+        atual = anterior;
+    }
+}
+
+/**
+ * memoriaRegistro() - Estruturas dos casos residentes + textos internados
+ */
+size_t memoriaRegistro(const RegistroCasos *registro) {
+    if (registro == NULL) return 0;
+    return registro->memoriaCasos + bytesTextosInternados();
+}
+
+/**
+ * liberarRegistroCasos() - Despeja ociosos e desvincula os casos em uso
+ */
+void liberarRegistroCasos(RegistroCasos *registro) {
+    if (registro == NULL) return;
+
+    CasoDetective *atual = registro->maisRecente;
+    while (atual != NULL) {
+        CasoDetective *proximo = atual->proximo;
+        if (atual->referencias == 0) {
+            despejarCaso(registro, atual);
+        } else {
+            // Passa a ser avulso: liberado pelo último soltarCaso()
+            desvincularCaso(registro, atual);
+            atual->registro = NULL;
+        }
+        atual = proximo;
+    }
+
+    free(registro);
+}
@@ -0,0 +1,102 @@
+/**
+ * DETECTIVE QUEST - Registro de Casos (Header)
+ * Carrega casos sob demanda e despeja casos ociosos (LRU) dentro de um orçamento de memória
+ */
+
+#ifndef REGISTRO_CASOS_H
+#define REGISTRO_CASOS_H
+
+#include "detective_quest.h"
+
+#define MAX_FONTES_CASOS 64
+#define CASO_PADRAO "mansao_escura"  // Caso jogado quando nenhum é escolhido
+
+// ============ ESTRUTURAS DE DADOS ============
+
+/**
+ * Fonte de um caso: nome, carregador e instância residente (se houver)
+ */
+typedef struct {
+    char nome[SALA_LEN];
+    CarregadorCaso carregar;
+    CasoDetective *residente;   // NULL se o caso não está carregado
+} FonteCaso;
+
+/**
+ * Registro de casos
+ * Casos residentes formam uma lista duplamente encadeada em ordem de uso
+ */
+typedef struct RegistroCasos {
+    FonteCaso fontes[MAX_FONTES_CASOS];
+    int totalFontes;
+    CasoDetective *maisRecente;     // Cabeça da lista LRU
+    CasoDetective *menosRecente;    // Cauda da lista LRU (primeiro a ser despejado)
+    size_t orcamento;               // Limite de memória (casos + pool de textos)
+    size_t memoriaCasos;            // Soma de CasoDetective.memoria dos residentes
+    int carregamentos;              // Estatística: casos carregados
+    int despejos;                   // Estatística: casos despejados
+} RegistroCasos;
+
+// ============ FUNÇÕES DO REGISTRO ============
+
+/**
+ * criarRegistroCasos() - Cria um registro vazio
+ *
+ * @param orcamento: Memória máxima em bytes para casos residentes + pool de textos
+ * @return: Registro ou NULL em falha de alocação
+ */
+RegistroCasos *criarRegistroCasos(size_t orcamento);
+
+/**
+ * registrarFonteCaso() - Associa um nome de caso ao seu carregador
+ *
+ * O caso só é carregado na primeira chamada a obterCaso().
+ *
+ * @return: 1 se registrado, 0 se o registro está cheio ou o nome já existe
+ */
+int registrarFonteCaso(RegistroCasos *registro, const char *nome, CarregadorCaso carregar);
+
+/**
+ * registrarCasosEmbutidos() - Registra as fontes dos casos que acompanham o jogo
+ *
+ * Usada pelo jogo e pelo leitor do diário, para que ambos resolvam os
+ * mesmos nomes de caso.
+ *
+ * @return: 1 se todas foram registradas, 0 caso contrário
+ */
+int registrarCasosEmbutidos(RegistroCasos *registro);
+
+/**
+ * obterCaso() - Retorna o caso, carregando-o se não estiver residente
+ *
+ * Marca o caso como o mais recente e devolve uma referência que deve
+ * ser solta com soltarCaso(). Após carregar, despeja casos ociosos
+ * menos recentes enquanto a memória exceder o orçamento.
+ *
+ * @param registro: Registro de casos
+ * @param nome: Nome do caso registrado
+ * @return: Caso retido ou NULL se desconhecido ou em erro de carga
+ */
+CasoDetective *obterCaso(RegistroCasos *registro, const char *nome);
+
+/**
+ * aplicarOrcamentoRegistro() - Despeja casos ociosos (LRU) até caber no orçamento
+ *
+ * Casos em uso nunca são despejados; se só restarem casos em uso, a
+ * memória pode ficar temporariamente acima do orçamento.
+ */
+void aplicarOrcamentoRegistro(RegistroCasos *registro);
+
+/**
+ * memoriaRegistro() - Memória contabilizada: casos residentes + pool de textos
+ */
+size_t memoriaRegistro(const RegistroCasos *registro);
+
+/**
+ * liberarRegistroCasos() - Libera casos ociosos e o registro
+ *
+ * Casos ainda em uso são desvinculados e liberados no último soltarCaso().
+ */
+void liberarRegistroCasos(RegistroCasos *registro);
+
+#endif // REGISTRO_CASOS_H